@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Opt-in allocation tracking (configure with -DENABLE_ALLOC_TRACKING=ON). When enabled, global
+// new/delete are replaced so every allocation is counted against the innermost alloc::Scope tag
+// on the calling thread. When disabled the scopes compile to nothing.
+namespace alloc {
+
+struct Counters {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+struct TagReport {
+    const char* name = nullptr;
+    Counters lastFrame;
+    Counters total;
+};
+
+#ifdef TRACK_ALLOCATIONS
+
+// Attribute allocations made on this thread to `tag` until the scope ends. The innermost scope
+// wins. The tag string must outlive the program (use literals).
+class Scope {
+  public:
+    explicit Scope(const char* tag);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    int previous;
+};
+
+// Marks code that must not allocate. Allocations on this thread inside the scope, and in the
+// jobs::ParallelFor chunks it dispatches, count as violations; with SetAssertOnViolation(true)
+// the first one aborts with the outermost scope's name.
+class NoAllocScope {
+  public:
+    explicit NoAllocScope(const char* name);
+    ~NoAllocScope();
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+    std::uint64_t Violations() const;
+
+  private:
+    friend class InheritNoAllocScope;
+    friend void RecordViolation(NoAllocScope* scope, std::size_t size);
+    const char* name;
+    NoAllocScope* parent;
+    std::atomic<std::uint64_t> violations{0};
+};
+
+// The calling thread's innermost no-allocation scope, or null
+NoAllocScope* CurrentNoAllocScope();
+
+// Checks this thread's allocations against a scope opened on another thread until the guard
+// ends. jobs::ParallelFor uses it so worker chunks count against the caller's scope.
+class InheritNoAllocScope {
+  public:
+    explicit InheritNoAllocScope(NoAllocScope* scope);
+    ~InheritNoAllocScope();
+    InheritNoAllocScope(const InheritNoAllocScope&) = delete;
+    InheritNoAllocScope& operator=(const InheritNoAllocScope&) = delete;
+
+  private:
+    NoAllocScope* previous;
+};
+
+void SetAssertOnViolation(bool enabled);
+
+// Close the current frame: counts gathered since the previous call become the last frame's
+void EndFrame();
+Counters LastFrame();
+Counters Total();
+// Fill `out` with up to maxReports per-tag reports; returns how many were written
+std::size_t GetReports(TagReport* out, std::size_t maxReports);
+
+// Allocator hooks for ImGui::SetAllocatorFunctions, counted under the "ImGui" tag
+void* ImGuiAlloc(std::size_t size, void* userData);
+void ImGuiFree(void* ptr, void* userData);
+
+#else
+
+class Scope {
+  public:
+    explicit Scope(const char*) {}
+};
+
+class NoAllocScope {
+  public:
+    explicit NoAllocScope(const char*) {}
+    std::uint64_t Violations() const {
+        return 0;
+    }
+};
+
+inline NoAllocScope* CurrentNoAllocScope() {
+    return nullptr;
+}
+
+class InheritNoAllocScope {
+  public:
+    explicit InheritNoAllocScope(NoAllocScope*) {}
+};
+
+inline void SetAssertOnViolation(bool) {}
+inline void EndFrame() {}
+
+#endif
+
+}  // namespace alloc
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+namespace bench {
+
+// Run a named benchmark without creating a window or GL context. Results go to the log.
+// Returns the process exit code.
+int Run(const std::string& name);
+
+}  // namespace bench
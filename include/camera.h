@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+class Heightfield;
+
+struct Camera {
+    float x, y, z;
+    float pitch, yaw;
+    float speed;
+};
+
+// Projection used for the main view, shared with headless tools
+constexpr float kCameraFovY = 60.0f * (3.1415926535f / 180.0f);
+constexpr float kCameraNear = 0.1f;
+constexpr float kCameraFar = 100.0f;
+// Height the camera keeps above the bilinear heightfield
+constexpr float kCameraGroundClearance = 0.25f;
+// tan(kCameraFovY / 2); std::tan is not constexpr before C++26
+constexpr float kCameraTanHalfFovY = 0.57735027f;
+// Widest window aspect ratio the mesh error limit below accounts for (21:9)
+constexpr float kCameraMaxAspect = 21.0f / 9.0f;
+
+namespace camera_detail {
+constexpr float Sqrt(float value) {
+    float root = value > 1.0f ? value : 1.0f;
+    for (int i = 0; i < 16; ++i)
+        root = 0.5f * (root + value / root);
+    return root;
+}
+}  // namespace camera_detail
+
+// Distance from the eye to a corner of the near plane at kCameraMaxAspect; looking straight down,
+// the corners reach this far below the eye
+constexpr float kCameraNearCornerDistance =
+    kCameraNear *
+    camera_detail::Sqrt(1.0f + kCameraTanHalfFovY * kCameraTanHalfFovY *
+                                   (1.0f + kCameraMaxAspect * kCameraMaxAspect));
+// The adaptive terrain mesh may sit up to its error tolerance above the heightfield. Below this
+// limit a camera resting at the clearance over flat ground never clips the mesh with its near
+// plane, at any orientation and at aspect ratios up to kCameraMaxAspect.
+constexpr float kMaxTerrainMeshError = kCameraGroundClearance - kCameraNearCornerDistance;
+
+// Camera-driving input for one frame, as polled from the keyboard and mouse
+struct FrameInput {
+    enum Key : std::uint8_t {
+        kForward = 1 << 0,
+        kBack = 1 << 1,
+        kLeft = 1 << 2,
+        kRight = 1 << 3,
+        kUp = 1 << 4,
+        kDown = 1 << 5,
+    };
+    std::uint8_t keys = 0;
+    float lookX = 0.0f, lookY = 0.0f;  // mouse movement in pixels while captured
+};
+
+// Advance the camera by one frame of input and keep it above the ground. Live input and replays
+// both go through here, so a recorded input stream reproduces the same flight.
+void ApplyInput(const FrameInput& input, const Heightfield& ground, Camera& camera);
+
+// Column-major view matrix for the camera, as uploaded to the uView uniform
+void BuildViewMatrix(const Camera& camera, float out[16]);
+// Column-major perspective projection, as uploaded to the uProjection uniform
+void BuildProjectionMatrix(float fovY, float aspect, float zNear, float zFar, float out[16]);
+// out = a * b for column-major 4x4 matrices
+void MultiplyMatrices(const float a[16], const float b[16], float out[16]);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Bump allocator over a chain of blocks. Reset() rewinds to the first block and keeps every
+// block for reuse, so once it has grown to the working set it stops touching the heap.
+class LinearArena {
+  public:
+    explicit LinearArena(std::size_t blockSize = 64 * 1024);
+    ~LinearArena();
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* AllocateArray(std::size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+    void Reset();
+
+    // Bytes handed out since the last reset, including alignment padding
+    std::size_t Used() const {
+        return used;
+    }
+    std::size_t Capacity() const {
+        return capacity;
+    }
+    // Largest Used() seen so far; a good starting block size for this arena
+    std::size_t HighWater() const {
+        return used > highWater ? used : highWater;
+    }
+
+  private:
+    struct Block {
+        Block* next;
+        std::size_t size;  // usable bytes after the header
+        std::size_t offset;
+    };
+
+    std::size_t blockSize;
+    Block* head = nullptr;
+    Block* current = nullptr;
+    std::size_t used = 0;
+    std::size_t capacity = 0;
+    std::size_t highWater = 0;
+};
+
+// std::pmr adaptor so standard containers can draw from an arena. Deallocation is a no-op; the
+// memory comes back when the arena is reset.
+class ArenaResource : public std::pmr::memory_resource {
+  public:
+    explicit ArenaResource(LinearArena& arena) : arena(arena) {}
+
+  private:
+    LinearArena& arena;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return arena.Allocate(bytes, alignment);
+    }
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Per-frame transient memory. Every thread gets its own pair of arenas; the one in use flips on
+// each BeginFrame and is rewound on first use in the new frame, so memory handed out during
+// frame N stays valid until the start of frame N + 2.
+namespace frame {
+
+struct Stats {
+    std::uint64_t frame = 0;
+    std::size_t mainUsed = 0;       // main thread, previous frame
+    std::size_t mainCapacity = 0;   // main thread, both arenas
+    std::size_t mainHighWater = 0;  // main thread, any frame
+    std::size_t workerHighWater = 0;
+    std::size_t workerCapacity = 0;
+    int threads = 0;
+};
+
+// Start a new frame. Call once per frame from the main loop before anything uses the arena.
+void BeginFrame();
+std::uint64_t Index();
+// Arena for the calling thread in the current frame
+LinearArena& Arena();
+std::pmr::memory_resource* Resource();
+Stats GetStats();
+
+}  // namespace frame
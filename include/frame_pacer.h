@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+enum class PresentMode {
+    kVsync,     // swap interval 1
+    kAdaptive,  // swap interval -1: vsync, but late frames tear instead of waiting a refresh
+    kUncapped,  // swap interval 0
+    kLimited,   // swap interval 0 plus the CPU frame limiter
+};
+
+const char* PresentModeName(PresentMode mode);
+bool ParsePresentMode(std::string_view name, PresentMode& mode);
+
+struct PresentOptions {
+    PresentMode mode = PresentMode::kVsync;
+    float targetFps = 60.0f;
+    // Limiter only: wait before sampling input instead of before the swap, so the frame is
+    // built from the freshest input and presented right after it is rendered
+    bool lowLatency = false;
+};
+
+// Frame pacing over the recent history
+struct PacingStats {
+    double targetMs = 0.0;  // expected frame interval; 0 when uncapped
+    double averageMs = 0.0;
+    double jitterMs = 0.0;  // standard deviation of the frame interval
+    double worstMs = 0.0;
+    int samples = 0;  // frames in the history
+    int missed = 0;   // frames in the history longer than 1.5x the target
+    std::uint64_t missedTotal = 0;
+    std::uint64_t frames = 0;
+};
+
+// Presentation mode and frame limiter. The limiter sleeps until shortly before the deadline and
+// spins the rest of the way, so it is accurate to well under a millisecond without burning a
+// core for the whole frame. The spin window adapts to how much the OS oversleeps.
+class FramePacer {
+  public:
+    static constexpr int kHistory = 240;
+
+    FramePacer() = default;
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Apply the options to the current GL context. Needs a current context.
+    void Configure(const PresentOptions& options);
+    const PresentOptions& Options() const {
+        return options;
+    }
+    void SetMode(PresentMode mode);
+    void SetTargetFps(float fps);
+    void SetLowLatency(bool enabled);
+
+    // Frame boundaries, in loop order: before input is sampled, right before the buffer swap,
+    // right after it
+    void BeginFrame();
+    void BeforeSwap();
+    void AfterSwap();
+
+    PacingStats Stats() const;
+    // Recent frame intervals in ms; the oldest entry is at HistoryOffset()
+    const float* History() const {
+        return history;
+    }
+    int HistoryOffset() const {
+        return historyNext;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    PresentOptions options;
+    int refreshRate = 60;
+    Clock::time_point deadline{};
+    Clock::duration spinMargin = std::chrono::microseconds(1500);
+    Clock::time_point lastPresent{};
+    float history[kHistory] = {};
+    int historyNext = 0;
+    int historyCount = 0;
+    std::uint64_t frames = 0;
+    std::uint64_t missedTotal = 0;
+    bool fineTimer = false;
+
+    double TargetMs() const;
+    // Raise the OS timer resolution while the limiter runs (Windows only)
+    void SetFineTimer(bool enabled);
+    void WaitForDeadline();
+    void SleepUntil(Clock::time_point until);
+};
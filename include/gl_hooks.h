@@ -0,0 +1,171 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "gl_stats.h"
+
+// Include after the GL headers in every source that calls GL. With TRACK_GL_CALLS the entry
+// points below are redirected to wrappers that count the call before forwarding it; calls made
+// elsewhere (the ImGui backend, GLFW) are not seen. Add new entry points here and in
+// gl_stats.cpp as the renderer starts using them.
+#ifdef TRACK_GL_CALLS
+
+namespace glstats::hooks {
+
+// Draws
+void Clear(GLbitfield mask);
+void DrawArrays(GLenum mode, GLint first, GLsizei count);
+void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void MultiDrawElements(GLenum mode,
+                       const GLsizei* count,
+                       GLenum type,
+                       const void* const* indices,
+                       GLsizei drawcount);
+
+// State
+void BeginQuery(GLenum target, GLuint id);
+void BindBuffer(GLenum target, GLuint buffer);
+void BindVertexArray(GLuint array);
+void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void Disable(GLenum cap);
+void Enable(GLenum cap);
+void EnableVertexAttribArray(GLuint index);
+void EndQuery(GLenum target);
+void Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void UseProgram(GLuint program);
+void VertexAttribPointer(GLuint index,
+                         GLint size,
+                         GLenum type,
+                         GLboolean normalized,
+                         GLsizei stride,
+                         const void* pointer);
+void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+// Uploads
+void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+void CopyBufferSubData(GLenum readTarget,
+                       GLenum writeTarget,
+                       GLintptr readOffset,
+                       GLintptr writeOffset,
+                       GLsizeiptr size);
+void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+GLboolean UnmapBuffer(GLenum target);
+
+// Synchronous queries
+void GetIntegerv(GLenum pname, GLint* data);
+void GetQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+const GLubyte* GetString(GLenum name);
+GLint GetUniformLocation(GLuint program, const GLchar* name);
+GLboolean IsEnabled(GLenum cap);
+
+// Objects and shaders
+void AttachShader(GLuint program, GLuint shader);
+void CompileShader(GLuint shader);
+GLuint CreateProgram();
+GLuint CreateShader(GLenum type);
+void DeleteBuffers(GLsizei n, const GLuint* buffers);
+void DeleteQueries(GLsizei n, const GLuint* ids);
+void GenBuffers(GLsizei n, GLuint* buffers);
+void GenQueries(GLsizei n, GLuint* ids);
+void GenVertexArrays(GLsizei n, GLuint* arrays);
+void LinkProgram(GLuint program);
+void ShaderSource(GLuint shader,
+                  GLsizei count,
+                  const GLchar* const* string,
+                  const GLint* length);
+
+}  // namespace glstats::hooks
+
+// gl_stats.cpp defines the wrappers in terms of the real entry points
+#ifndef GL_HOOKS_IMPLEMENTATION
+
+// GLEW declares most entry points as macros over function pointers, so each is undefined first
+#undef glClear
+#define glClear glstats::hooks::Clear
+#undef glDrawArrays
+#define glDrawArrays glstats::hooks::DrawArrays
+#undef glDrawElements
+#define glDrawElements glstats::hooks::DrawElements
+#undef glMultiDrawElements
+#define glMultiDrawElements glstats::hooks::MultiDrawElements
+
+#undef glBeginQuery
+#define glBeginQuery glstats::hooks::BeginQuery
+#undef glBindBuffer
+#define glBindBuffer glstats::hooks::BindBuffer
+#undef glBindVertexArray
+#define glBindVertexArray glstats::hooks::BindVertexArray
+#undef glClearColor
+#define glClearColor glstats::hooks::ClearColor
+#undef glDisable
+#define glDisable glstats::hooks::Disable
+#undef glEnable
+#define glEnable glstats::hooks::Enable
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray glstats::hooks::EnableVertexAttribArray
+#undef glEndQuery
+#define glEndQuery glstats::hooks::EndQuery
+#undef glUniform3f
+#define glUniform3f glstats::hooks::Uniform3f
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv glstats::hooks::UniformMatrix4fv
+#undef glUseProgram
+#define glUseProgram glstats::hooks::UseProgram
+#undef glVertexAttribPointer
+#define glVertexAttribPointer glstats::hooks::VertexAttribPointer
+#undef glViewport
+#define glViewport glstats::hooks::Viewport
+
+#undef glBufferData
+#define glBufferData glstats::hooks::BufferData
+#undef glBufferSubData
+#define glBufferSubData glstats::hooks::BufferSubData
+#undef glCopyBufferSubData
+#define glCopyBufferSubData glstats::hooks::CopyBufferSubData
+#undef glMapBufferRange
+#define glMapBufferRange glstats::hooks::MapBufferRange
+#undef glUnmapBuffer
+#define glUnmapBuffer glstats::hooks::UnmapBuffer
+
+#undef glGetIntegerv
+#define glGetIntegerv glstats::hooks::GetIntegerv
+#undef glGetQueryObjectiv
+#define glGetQueryObjectiv glstats::hooks::GetQueryObjectiv
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v glstats::hooks::GetQueryObjectui64v
+#undef glGetString
+#define glGetString glstats::hooks::GetString
+#undef glGetUniformLocation
+#define glGetUniformLocation glstats::hooks::GetUniformLocation
+#undef glIsEnabled
+#define glIsEnabled glstats::hooks::IsEnabled
+
+#undef glAttachShader
+#define glAttachShader glstats::hooks::AttachShader
+#undef glCompileShader
+#define glCompileShader glstats::hooks::CompileShader
+#undef glCreateProgram
+#define glCreateProgram glstats::hooks::CreateProgram
+#undef glCreateShader
+#define glCreateShader glstats::hooks::CreateShader
+#undef glDeleteBuffers
+#define glDeleteBuffers glstats::hooks::DeleteBuffers
+#undef glDeleteQueries
+#define glDeleteQueries glstats::hooks::DeleteQueries
+#undef glGenBuffers
+#define glGenBuffers glstats::hooks::GenBuffers
+#undef glGenQueries
+#define glGenQueries glstats::hooks::GenQueries
+#undef glGenVertexArrays
+#define glGenVertexArrays glstats::hooks::GenVertexArrays
+#undef glLinkProgram
+#define glLinkProgram glstats::hooks::LinkProgram
+#undef glShaderSource
+#define glShaderSource glstats::hooks::ShaderSource
+
+#endif  // GL_HOOKS_IMPLEMENTATION
+
+#endif  // TRACK_GL_CALLS
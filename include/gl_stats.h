@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Opt-in GL call statistics (configure with -DENABLE_GL_STATS=ON). When enabled, sources that
+// include gl_hooks.h call the GL entry points through counting wrappers. When disabled the
+// wrappers are not compiled and EndFrame is a no-op.
+namespace glstats {
+
+enum class Category { kDraw, kState, kUpload, kQuery, kObject };
+
+struct Counters {
+    std::uint64_t calls = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t stateChanges = 0;
+    std::uint64_t uploads = 0;
+    std::uint64_t uploadBytes = 0;  // bytes handed to the driver by uploads and write mappings
+    std::uint64_t queries = 0;      // synchronous reads of GL state or query results
+    std::uint64_t objects = 0;      // object creation, deletion and shader compilation
+    std::uint64_t syncCalls = 0;    // calls that can stall on the driver or the GPU
+};
+
+// Counts for one entry point
+struct CallCounters {
+    std::uint64_t calls = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t syncCalls = 0;
+};
+
+struct CallReport {
+    const char* name = nullptr;
+    Category category = Category::kState;
+    CallCounters lastFrame;
+    CallCounters total;
+};
+
+#ifdef TRACK_GL_CALLS
+
+const char* CategoryName(Category category);
+
+// Close the current frame: counts gathered since the previous call become the last frame's
+void EndFrame();
+// Counts since the last EndFrame
+Counters CurrentFrame();
+Counters LastFrame();
+Counters Total();
+// Fill `out` with up to maxReports reports for the entry points called so far; returns how many
+// were written
+std::size_t GetReports(CallReport* out, std::size_t maxReports);
+
+#else
+
+inline void EndFrame() {}
+
+#endif
+
+}  // namespace glstats
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// GPU frame timing with GL_TIME_ELAPSED queries. Queries rotate through a small ring and are
+// read a few frames late, so timing never stalls the pipeline; only a full ring or Finish()
+// waits for results.
+class GpuTimer {
+  public:
+    static constexpr int kLatency = 4;
+
+    void Initialize();
+    void Shutdown();
+    // Bracket the GL work of frame `frame`; results land in Results()[frame]
+    void Begin(std::size_t frame);
+    void End();
+    // Collect finished queries without waiting
+    void Poll();
+    // Wait for all outstanding queries
+    void Finish();
+    // Milliseconds per frame; negative for frames without a result
+    const std::vector<double>& Results() const {
+        return results;
+    }
+
+  private:
+    unsigned int queries[kLatency] = {};
+    std::size_t frames[kLatency] = {};
+    bool pending[kLatency] = {};
+    int next = 0;
+    bool initialized = false;
+    std::vector<double> results;
+
+    bool Collect(int slot, bool wait);
+};
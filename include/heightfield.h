@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Resident CPU copy of the terrain: a square grid of height samples on the XZ plane,
+// centered at the origin. Sample (x, z) sits at world (OriginX() + x * cellSize, ., OriginZ() +
+// z * cellSize) and is stored row-major (z * Size() + x).
+class Heightfield {
+  public:
+    // Fill the grid with the layered-noise terrain used by the renderer
+    void Generate(int vertsPerSide, float cellSize);
+
+    // Bilinear height at a world XZ position; positions outside the grid clamp to its edge
+    float SampleHeight(float x, float z) const;
+    // Unit surface normal of the bilinear patch at a world XZ position
+    void SampleNormal(float x, float z, float& nx, float& ny, float& nz) const;
+    // Batched variants over structure-of-arrays positions. SIMD where available; they do not
+    // allocate, so gameplay code can call them every frame.
+    void SampleHeights(const float* xs, const float* zs, float* outHeights, std::size_t count) const;
+    void SampleNormals(const float* xs,
+                       const float* zs,
+                       float* outX,
+                       float* outY,
+                       float* outZ,
+                       std::size_t count) const;
+    bool Contains(float x, float z) const;
+
+    int Size() const {
+        return size;
+    }
+    float CellSize() const {
+        return cellSize;
+    }
+    float OriginX() const {
+        return originX;
+    }
+    float OriginZ() const {
+        return originZ;
+    }
+    float MinHeight() const {
+        return minHeight;
+    }
+    float MaxHeight() const {
+        return maxHeight;
+    }
+    float At(int x, int z) const {
+        return heights[static_cast<std::size_t>(z) * size + x];
+    }
+    // Editing: change one sample. The height range only grows, so it stays a valid bound.
+    void SetHeight(int x, int z, float h) {
+        heights[static_cast<std::size_t>(z) * size + x] = h;
+        minHeight = std::min(minHeight, h);
+        maxHeight = std::max(maxHeight, h);
+    }
+    const float* Data() const {
+        return heights.data();
+    }
+    bool Empty() const {
+        return heights.empty();
+    }
+
+  private:
+    int size = 0;
+    float cellSize = 0.0f;
+    float originX = 0.0f, originZ = 0.0f;
+    float minHeight = 0.0f, maxHeight = 0.0f;
+    std::vector<float> heights;
+};
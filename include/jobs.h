@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace jobs {
+
+// Start the worker pool. A count of 0 picks hardware_concurrency - 1 workers.
+void Initialize(unsigned int workerCount = 0);
+void Shutdown();
+unsigned int WorkerCount();
+
+namespace detail {
+struct TaskState;
+using RangeFn = void (*)(void* context, std::size_t begin, std::size_t end);
+void ParallelFor(std::size_t count, std::size_t grain, RangeFn fn, void* context);
+}  // namespace detail
+
+// Split [0, count) into chunks of at most `grain` items and call fn(begin, end) for each chunk
+// on the workers. The calling thread helps and returns once every chunk has finished.
+// Does not allocate, so it is safe to call from the frame loop.
+template <typename Fn>
+void ParallelFor(std::size_t count, std::size_t grain, Fn&& fn) {
+    using FnType = std::remove_reference_t<Fn>;
+    detail::ParallelFor(
+        count,
+        grain,
+        [](void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<FnType*>(context))(begin, end);
+        },
+        const_cast<void*>(static_cast<const void*>(&fn)));
+}
+
+// Handle to a background task started with Async
+class Task {
+  public:
+    // True once the task has finished; also true for an empty handle
+    bool Done() const;
+    // Block until the task has finished. A task no worker has picked up yet runs on the caller.
+    void Wait() const;
+
+  private:
+    friend Task Async(std::function<void()> fn);
+    std::shared_ptr<detail::TaskState> state;
+};
+
+// Run fn on a worker without waiting for it, for long-running work such as loading. Workers take
+// ParallelFor chunks before tasks, and one busy with a task cannot help ParallelFor until it is
+// done. Without workers fn runs right away on the caller. Allocates; not for per-frame use.
+Task Async(std::function<void()> fn);
+
+}  // namespace jobs
@@ -1,17 +1,22 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace logging {
 
 void Initialize();
 void Shutdown();
-std::vector<std::string> GetRecentLogs(std::size_t maxLines = 100);
-void LogMessage(const std::string& level, const std::string& message);
+// Copy of the newest log lines, allocated from `resource` (e.g. the frame arena)
+std::pmr::vector<std::pmr::string> GetRecentLogs(
+    std::size_t maxLines = 100,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+void LogMessage(std::string_view level, std::string_view message);
 
-// printf-style formatting helper
-std::string format(const char* fmt, ...);
+// printf-style formatting helper; the result lives in the calling thread's frame arena
+std::pmr::string format(const char* fmt, ...);
 
 }  // namespace logging
 
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// World-space axis-aligned bounding box
+struct Bounds {
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+};
+
+// CPU occlusion culling. Occluder triangles are rasterized into a low-resolution depth buffer
+// (nearest depth per pixel; SSE2 where available, row strips spread over the job system), a
+// max-depth level over 8x8 blocks is built on top, and bounding boxes are tested against it.
+// Everything is CPU-side so it runs without a GL context.
+class OcclusionCuller {
+  public:
+    static constexpr int kWidth = 256;
+    static constexpr int kHeight = 128;
+    static constexpr int kBlockSize = 8;
+
+    // Start a view: clear the depth buffer. viewProj is column-major, as passed to GL; vertices
+    // closer than nearW (clip-space w) are treated as crossing the near plane.
+    void BeginFrame(const float viewProj[16], float nearW);
+    // Rasterize indexed occluder triangles; positions are world-space xyz triples
+    void RasterizeOccluders(const float* positions,
+                            std::size_t vertexCount,
+                            const std::uint32_t* indices,
+                            std::size_t triangleCount);
+    // False when the box is entirely off screen or certainly hidden behind occluders
+    bool IsVisible(const Bounds& box) const;
+    // Batched IsVisible across the job system; visible[i] is set to 1 or 0
+    void TestVisibility(const Bounds* boxes, std::uint8_t* visible, std::size_t count) const;
+
+    const float* DepthBuffer() const {
+        return depth.data();
+    }
+
+  private:
+    struct ScreenVertex {
+        float x, y, z;  // pixels and depth in [0, 1]; z < 0 marks a vertex behind the near plane
+    };
+
+    float viewProj[16] = {};
+    float nearW = 0.1f;
+    std::vector<float> depth;     // kWidth * kHeight
+    std::vector<float> blockMax;  // farthest depth per block
+    std::vector<ScreenVertex> screenVertices;
+
+    void RasterizeStrip(int rowBegin,
+                        int rowEnd,
+                        const std::uint32_t* indices,
+                        std::size_t triangleCount);
+    void BuildBlocks(int rowBegin, int rowEnd);
+};
@@ -3,42 +3,127 @@
 // GLEW provides OpenGL function declarations
 #include <GL/glew.h>
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
-struct GLFWwindow;
+#include "camera.h"
+#include "jobs.h"
+#include "staged_upload.h"
+#include "terrain_scene.h"
 
-struct Camera {
-    float x, y, z;
-    float pitch, yaw;
-    float speed;
-};
+struct GLFWwindow;
 
 struct Color {
     float r, g, b;
 };
 
+// Terrain edits picked up by the last Render call
+struct TerrainEditStats {
+    std::size_t stamps = 0;
+    int tilesRemeshed = 0;
+    float cpuMs = 0.0f;  // TerrainScene::FlushEdits
+    int uploadCalls = 0;
+    std::size_t uploadBytes = 0;
+};
+
 class Renderer {
   public:
+    // Starts loading in the background and returns; see Ready()
     bool Initialize(GLFWwindow* window);
+    // Also advances loading; until Ready() it only clears the frame
     void Render(const Camera& camera, Color& color);
     void Cleanup();
+    // Shaders and terrain are loaded and resident on the GPU. The terrain accessors below must
+    // not be used before, while a worker is still building it.
+    bool Ready() const {
+        return loadStage == LoadStage::kReady;
+    }
+    const char* LoadingStatus() const;
+    float LoadingProgress() const;
+    // Terrain point under the cursor (or crosshair) from the last Render call
+    const RayHit& GetLastPick() const {
+        return lastPick;
+    }
+    const Heightfield& GetHeightfield() const {
+        return scene.GetHeightfield();
+    }
+    void SetOcclusionCulling(bool enabled) {
+        scene.SetOcclusionCulling(enabled);
+    }
+    bool OcclusionCullingEnabled() const {
+        return scene.OcclusionCullingEnabled();
+    }
+    // Project with a fixed aspect ratio instead of the viewport's, e.g. the one a replay was
+    // recorded with; 0 goes back to the viewport
+    void SetAspectRatio(float aspect) {
+        aspectOverride = aspect;
+    }
+    // Re-triangulate the terrain (see TerrainScene::BuildMesh) and upload the new indices
+    void SetTerrainMesh(bool adaptive, float maxError);
+    // Stamp a brush on the terrain; the GPU copy is updated at the start of the next Render
+    void EditTerrain(const Brush& brush) {
+        scene.ApplyBrush(brush);
+    }
+    const TerrainEditStats& GetEditStats() const {
+        return editStats;
+    }
+    const TerrainScene& GetScene() const {
+        return scene;
+    }
+    const CullingStats& GetCullingStats() const {
+        return cullingStats;
+    }
 
   private:
     GLFWwindow* window = nullptr;
-    unsigned int shaderProgram;
+    unsigned int shaderProgram = 0;
     unsigned int gridVAO, cubeVAO, crosshairVAO, crosshairVBO, tracerVAO, tracerVBO;
     int gridIndicesCount;
 
     // Terrain buffers
+    static constexpr int kTerrainVertexStride = 6;
     unsigned int terrainVBO = 0, terrainEBO = 0;
+    std::vector<float> terrainVertices;
+    TerrainEditStats editStats;
+
+    // Asynchronous startup
+    enum class LoadStage { kLoading, kUploading, kReady };
+    // Terrain upload: sent in slices through the staging buffer, a few per frame
+    static constexpr std::size_t kUploadSliceBytes = 256 * 1024;
+    static constexpr std::size_t kUploadBytesPerFrame = 1024 * 1024;
+    struct ShaderFiles {
+        std::string vertexPath, fragmentPath;
+        std::string vertexSource, fragmentSource;  // empty if the file could not be read
+    };
+    LoadStage loadStage = LoadStage::kLoading;
+    jobs::Task shaderTask, terrainTask;
+    ShaderFiles shaderFiles;
+    StagedUploader uploader;
+    double uploadStartMs = 0.0, uploadMainMs = 0.0;
+    std::size_t uploadBytes = 0;
+    int uploadFrames = 0;
+
+    // CPU-side terrain for picking and culling
+    TerrainScene scene;
+    RayHit lastPick;
+    CullingStats cullingStats;
+    float aspectOverride = 0.0f;
 
     unsigned int CreateShader(const char* vertexSource, const char* fragmentSource);
-    unsigned int CreateShaderFromFiles(const char* vertexPath, const char* fragmentPath);
+    // Worker side of startup
+    void LoadShaderSources(const char* vertexPath, const char* fragmentPath);
+    void BuildTerrain();
+    // Main thread side: GL objects once the workers are done
+    void PumpStartup();
+    unsigned int BuildShaderProgram();
     static std::string ReadTextFile(const char* path);
     void CreateGrid();
+    void WriteTerrainVertices(const BufferSpan& span);
+    void UploadTerrainIndices();
+    void UploadTerrainEdits();
     void CreateCube();
     void CreateCrosshair();
     // Update tracer line in screen space (NDC). Endpoints are in range [-1,1].
     void UpdateTracerNDC(float x1, float y1, float x2, float y2);
-    float SimpleNoise(float x, float y);
 };
\ No newline at end of file
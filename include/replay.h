@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "camera.h"
+
+// One recorded frame: the input and the camera state it produced
+struct RecordedFrame {
+    double time = 0.0;  // seconds since the recording started
+    FrameInput input;
+    Camera camera{};
+};
+
+// A recorded flight: starting camera, viewport aspect and per-frame input
+struct Recording {
+    float aspect = 1.0f;
+    Camera start{};
+    std::vector<RecordedFrame> frames;
+};
+
+// Measurements for one replayed frame
+struct FrameTiming {
+    double cpuMs = 0.0;   // frame CPU time up to the buffer swap
+    double gpuMs = -1.0;  // GPU time of the frame's draw calls; negative when not measured
+    double cullMs = 0.0;
+    int triangles = 0;
+    int drawCalls = 0;
+    // GL call statistics; only gathered in builds with ENABLE_GL_STATS
+    std::uint64_t glCalls = 0;
+    std::uint64_t glSyncCalls = 0;
+    std::uint64_t uploadBytes = 0;
+};
+
+namespace replay {
+
+// Compact little-endian binary file: a header plus one fixed-size record per frame
+bool Save(const std::string& path, const Recording& recording);
+bool Load(const std::string& path, Recording& recording);
+
+// Largest difference between two camera states; a replay re-simulating its input should stay at 0
+float Drift(const Camera& a, const Camera& b);
+
+// Per-frame timings as CSV, and a percentile summary in the log
+bool WriteTimings(const std::string& path, const std::vector<FrameTiming>& timings);
+void LogSummary(const std::vector<FrameTiming>& timings);
+
+// Replay without a window or GL context: input, camera and CPU culling for every frame.
+// Returns the process exit code.
+int RunHeadless(const std::string& recordingPath, const std::string& timingsPath);
+
+}  // namespace replay
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+// Streams large buffer uploads over several frames through a staging buffer. Each slice is
+// written with an invalidating map, so the driver hands out fresh memory instead of waiting for
+// the GPU to consume the previous slice, and is then copied into place on the GPU with
+// glCopyBufferSubData. Needs a current GL context.
+class StagedUploader {
+  public:
+    void Initialize(std::size_t sliceBytes);
+    void Shutdown();
+    // Queue `bytes` from `data` for `buffer` at `offset`. The buffer must already have its
+    // storage, and `data` must stay valid until Idle().
+    void Enqueue(unsigned int buffer, std::size_t offset, const void* data, std::size_t bytes);
+    // Upload queued data in slices until about `budgetBytes` went out; returns the bytes sent
+    std::size_t Pump(std::size_t budgetBytes);
+    bool Idle() const {
+        return queue.empty();
+    }
+    std::size_t PendingBytes() const;
+
+  private:
+    struct Pending {
+        unsigned int buffer;
+        std::size_t offset;
+        const unsigned char* data;
+        std::size_t bytes;
+        std::size_t sent;
+    };
+
+    unsigned int staging = 0;
+    std::size_t sliceBytes = 0;
+    std::deque<Pending> queue;
+};
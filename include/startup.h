@@ -0,0 +1,32 @@
+#pragma once
+
+// Time-to-first-frame breakdown. Phases are recorded as they finish, on any thread, relative to
+// Begin(); Finish() logs them together once startup is over.
+namespace startup {
+
+// Reference point for all phases; call first thing in main
+void Begin();
+double MillisecondsSinceBegin();
+// Record a phase that ran from startMs to now; `name` must be a string literal
+void Record(const char* name, double startMs);
+// The first presented frame, placeholder or not
+void MarkFirstFrame();
+// Log the breakdown; later calls do nothing
+void Finish();
+
+// Records the enclosing scope as a phase
+class Phase {
+  public:
+    explicit Phase(const char* name) : name(name), startMs(MillisecondsSinceBegin()) {}
+    ~Phase() {
+        Record(name, startMs);
+    }
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+
+  private:
+    const char* name;
+    double startMs;
+};
+
+}  // namespace startup
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Heightfield;
+
+// Inclusive rectangle of heightfield samples (or cells), in grid coordinates
+struct GridRect {
+    int minX = 0, minZ = 0;
+    int maxX = -1, maxZ = -1;
+
+    bool Empty() const {
+        return maxX < minX || maxZ < minZ;
+    }
+    std::size_t Area() const {
+        return Empty() ? 0 : static_cast<std::size_t>(maxX - minX + 1) * (maxZ - minZ + 1);
+    }
+};
+
+// Smallest rectangle covering both
+GridRect Union(const GridRect& a, const GridRect& b);
+// Grow by `amount` on every side and clamp to [0, limit]
+GridRect Expand(const GridRect& rect, int amount, int limit);
+
+enum class BrushMode { kRaise, kLower, kFlatten };
+
+// One stamp of a round brush with a smooth falloff to zero at `radius` (world units).
+// Raise and lower move the centre by `strength` world units; flatten moves it `strength` (0..1)
+// of the way towards `height`.
+struct Brush {
+    BrushMode mode = BrushMode::kRaise;
+    float x = 0.0f, z = 0.0f;
+    float radius = 1.0f;
+    float strength = 0.01f;
+    float height = 0.0f;
+};
+
+// Apply a brush stamp to the heightfield and return the samples it touched
+GridRect ApplyBrush(Heightfield& field, const Brush& brush);
+
+// A small fixed set of dirty rectangles. Overlapping or touching rectangles are merged as they
+// are added; once the set is full a new rectangle joins whichever one grows the least, so any
+// number of edits per frame stays bounded without allocating.
+class DirtyRegions {
+  public:
+    static constexpr std::size_t kMaxRects = 8;
+
+    void Add(const GridRect& rect);
+    void Clear() {
+        count = 0;
+    }
+    bool Empty() const {
+        return count == 0;
+    }
+    std::size_t Count() const {
+        return count;
+    }
+    const GridRect& operator[](std::size_t i) const {
+        return rects[i];
+    }
+
+  private:
+    std::array<GridRect, kMaxRects> rects{};
+    std::size_t count = 0;
+};
+
+// A run of elements in a GPU buffer: vertices or indices
+struct BufferSpan {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "terrain_edit.h"
+#include "terrain_tiles.h"
+
+class Heightfield;
+
+// Error-bounded adaptive triangulation of heightfield tiles as a right-triangulated irregular
+// network (RTIN), in the style of Martini. Every grid vertex stores the largest vertical distance
+// between the heightfield and the two triangles it splits, propagated up the triangle hierarchy;
+// a tile is then refined from its two halves only where that error exceeds the tolerance. Errors
+// are global, so neighbouring tiles agree on their shared edges and the mesh has no cracks.
+class TerrainMesher {
+  public:
+    // Compute the error map, one hierarchy level at a time across the job system. tileCells must
+    // be a power of two that divides the heightfield's cell count.
+    void Build(const Heightfield& field, int tileCells);
+    // Recompute the error map around heights that changed; returns the vertices whose errors
+    // may differ, so tiles overlapping it need re-triangulating
+    GridRect Update(const Heightfield& field, const GridRect& changed);
+    // Triangulate a tile so that no grid vertex is more than maxError above or below the mesh,
+    // appending grid vertex indices (z * size + x) with the same winding as the regular grid
+    void AppendTile(const TerrainTile& tile,
+                    float maxError,
+                    std::vector<std::uint32_t>& indices) const;
+
+    bool Ready() const {
+        return !errors.empty();
+    }
+
+  private:
+    int size = 0;
+    int tileCells = 0;
+    std::vector<float> errors;
+
+    void ComputeErrors(const Heightfield& field, const GridRect& rect);
+    void Refine(int ax,
+                int az,
+                int bx,
+                int bz,
+                int cx,
+                int cz,
+                float maxError,
+                std::vector<std::uint32_t>& indices) const;
+};
+
+// Two triangles per cell, the layout used before adaptive meshing
+void AppendRegularTile(const TerrainTile& tile,
+                       int vertsPerSide,
+                       std::vector<std::uint32_t>& indices);
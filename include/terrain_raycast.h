@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "terrain_edit.h"
+
+class Heightfield;
+
+struct Ray {
+    float originX, originY, originZ;
+    float dirX, dirY, dirZ;  // need not be normalized; hit distances are in units of dir
+};
+
+struct RayHit {
+    bool hit = false;
+    float t = 0.0f;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+// Ray casts against the terrain heightfield. A max-height mip pyramid over the cells lets rays
+// skip whole regions they pass above; inside a leaf cell the two mesh triangles are tested.
+class TerrainRaycaster {
+  public:
+    // Build the pyramid. The heightfield must outlive the raycaster.
+    void Build(const Heightfield& field);
+    // Update the pyramid over a rectangle of cells whose heights changed
+    void Refresh(const GridRect& cells);
+    bool Ready() const {
+        return field != nullptr;
+    }
+
+    RayHit Cast(const Ray& ray, float maxT = std::numeric_limits<float>::max()) const;
+    // Cast many rays at once, spread across the job system's workers
+    void CastBatch(const Ray* rays,
+                   RayHit* hits,
+                   std::size_t count,
+                   float maxT = std::numeric_limits<float>::max()) const;
+
+  private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<float> maxHeights;  // row-major, one entry per node
+    };
+
+    const Heightfield* field = nullptr;
+    std::vector<Level> levels;  // levels[0] holds one node per heightfield cell
+
+    float CellMax(int x, int z) const;
+    static float ChildrenMax(const Level& child, int x, int z);
+    bool IntersectCell(const Ray& ray, int cellX, int cellZ, float tMin, float tMax, RayHit& hit)
+        const;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "camera.h"
+#include "heightfield.h"
+#include "occlusion.h"
+#include "terrain_edit.h"
+#include "terrain_mesher.h"
+#include "terrain_raycast.h"
+#include "terrain_tiles.h"
+
+// Per-frame culling results for the UI, replays and benchmarks
+struct CullingStats {
+    int tilesTotal = 0;
+    int tilesVisible = 0;
+    bool cubeVisible = true;
+    bool occlusionActive = false;  // occluders were rasterized (camera above the terrain)
+    float cpuMs = 0.0f;            // occluder rasterization and visibility tests
+    int drawCalls = 0;             // terrain ranges after merging adjacent visible tiles
+    int triangles = 0;             // triangles submitted for the terrain and objects
+};
+
+// A tile's index range in the terrain mesh. Edited tiles may leave part of their range unused;
+// it is padded with degenerate triangles so runs of tiles can still be drawn as one range.
+struct TileMesh {
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;  // indices of real triangles
+    std::uint32_t capacity = 0;    // indices reserved, including padding
+};
+
+// What FlushEdits changed and the GPU copy has to pick up. Spans are coalesced: sorted, merged
+// where they touch or nearly do, and whole rectangles instead of rows where that is cheaper.
+struct TerrainUpdate {
+    std::vector<BufferSpan> vertexSpans;  // grid vertices (z * vertsPerSide + x)
+    std::vector<BufferSpan> indexSpans;   // ranges of MeshIndices()
+    bool indicesRelaid = false;           // tiles were moved; upload MeshIndices() whole
+    std::size_t stamps = 0;               // brush stamps applied since the previous flush
+    int tilesRemeshed = 0;
+    float cpuMs = 0.0f;
+
+    bool Empty() const {
+        return vertexSpans.empty() && indexSpans.empty() && !indicesRelaid;
+    }
+};
+
+// CPU side of the terrain: heights, picking, draw tiles and culling. Needs no GL context, so
+// headless replays and benchmarks run the same per-frame work as the renderer.
+class TerrainScene {
+  public:
+    // Terrain used by the app: 256x256 cells of 0.2 units, ~51.2 units per side
+    static constexpr int kVertsPerSide = 257;
+    static constexpr float kCellSize = 0.2f;
+    static constexpr int kTileCells = 16;
+    // Occluders use finer tiles: a min-height box per draw tile is too low to hide much
+    static constexpr int kOccluderTileCells = 8;
+
+    // Default vertical error tolerance of the adaptive mesh, in world units
+    static constexpr float kDefaultMaxError = 0.05f;
+
+    // vertsPerSide - 1 must be a multiple of kTileCells
+    void Build(int vertsPerSide, float cellSize);
+    // Triangulate every tile across the job system: adaptively within maxError vertical error,
+    // or as the regular two-triangles-per-cell grid. Tiles stay contiguous in MeshIndices().
+    void BuildMesh(bool adaptive, float maxError);
+
+    // Apply a brush stamp to the heights right away. Bounds, picking, occluders and the mesh
+    // catch up in FlushEdits, so any number of stamps per frame costs one update.
+    void ApplyBrush(const Brush& brush);
+    // Bring everything derived from the heights up to date with the edits since the last flush
+    // and return what changed. Only the tiles and pyramid nodes around the edits are rebuilt.
+    const TerrainUpdate& FlushEdits();
+
+    // Frustum and occlusion culling for one view. Returns a visibility flag per tile followed by
+    // one per object box; the array lives in the calling thread's frame arena.
+    const std::uint8_t* Cull(const Camera& camera,
+                             const float viewProj[16],
+                             float zNear,
+                             const Bounds* objects,
+                             std::size_t objectCount);
+
+    const Heightfield& GetHeightfield() const {
+        return heightfield;
+    }
+    const TerrainRaycaster& GetRaycaster() const {
+        return raycaster;
+    }
+    const std::vector<TerrainTile>& Tiles() const {
+        return tiles;
+    }
+    // Indices into the grid's vertices (z * vertsPerSide + x), tile after tile; see TileMesh
+    const std::vector<std::uint32_t>& MeshIndices() const {
+        return meshIndices;
+    }
+    const std::vector<TileMesh>& TileMeshes() const {
+        return tileMeshes;
+    }
+    bool MeshAdaptive() const {
+        return meshAdaptive;
+    }
+    float MeshMaxError() const {
+        return meshMaxError;
+    }
+    // Triangles in the mesh, not counting padding
+    std::size_t MeshTriangleCount() const {
+        return meshTriangles;
+    }
+    // Triangle count of the regular grid, the baseline for the adaptive mesh
+    std::size_t RegularTriangleCount() const {
+        return tiles.size() * kTileCells * kTileCells * 2;
+    }
+    void SetOcclusionCulling(bool enabled) {
+        occlusionCulling = enabled;
+    }
+    bool OcclusionCullingEnabled() const {
+        return occlusionCulling;
+    }
+    // Results of the last Cull; object visibility and draw calls are left to the caller
+    const CullingStats& GetCullingStats() const {
+        return stats;
+    }
+
+  private:
+    Heightfield heightfield;
+    TerrainRaycaster raycaster;
+    std::vector<TerrainTile> tiles;
+    TerrainMesher mesher;
+    std::vector<std::uint32_t> meshIndices;
+    std::vector<TileMesh> tileMeshes;
+    std::size_t meshTriangles = 0;
+    bool meshAdaptive = false;
+    float meshMaxError = 0.0f;
+    std::vector<TerrainTile> occluderTiles;
+    std::vector<float> occluderPositions;
+    std::vector<std::uint32_t> occluderIndices;
+    OcclusionCuller culler;
+    bool occlusionCulling = true;
+    CullingStats stats;
+
+    // Editing
+    DirtyRegions pendingEdits;
+    std::size_t pendingStamps = 0;
+    TerrainUpdate update;
+    std::vector<std::uint8_t> tileDirty;
+    std::vector<std::uint32_t> dirtyTiles;
+    std::vector<std::vector<std::uint32_t>> tileScratch;
+    std::vector<std::uint32_t> relayoutScratch;
+
+    void RebuildOccluders();
+    void AddVertexSpans(const GridRect& rect);
+    void RemeshDirtyTiles();
+};
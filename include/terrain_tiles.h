@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "occlusion.h"
+#include "terrain_edit.h"
+
+class Heightfield;
+
+// Square block of heightfield cells drawn and culled as a unit
+struct TerrainTile {
+    int cellX = 0, cellZ = 0;  // first cell covered
+    int cells = 0;             // cells per side
+    float minHeight = 0.0f, maxHeight = 0.0f;
+    Bounds bounds{};
+};
+
+// Split the heightfield into tiles of tileCells x tileCells cells, row-major by tile. The
+// heightfield's cell count per side must be a multiple of tileCells.
+std::vector<TerrainTile> BuildTerrainTiles(const Heightfield& field, int tileCells);
+// Recompute a tile's height range and bounds after the heights changed
+void UpdateTileBounds(const Heightfield& field, TerrainTile& tile);
+// Tiles (in tile coordinates) of a grid from BuildTerrainTiles that contain any of the given
+// samples; samples on a tile edge belong to the tiles on both sides
+GridRect TilesOverlapping(const GridRect& samples, int tileCells, int tilesPerSide);
+
+// Conservative occluders for a tile grid from BuildTerrainTiles: the surface of the solid made of
+// one box per tile, from the tile's minimum height down to `floorY`. That is each tile's top plus
+// a wall wherever a neighbour is lower (down to `floorY` on the border); walls shared with a
+// higher neighbour are inside the solid and skipped. Everything in the solid lies under the
+// terrain surface, so it hides what is behind it as long as the camera is above the terrain.
+// Appends xyz positions and triangle indices.
+void AppendTileOccluders(const std::vector<TerrainTile>& tiles,
+                         float floorY,
+                         std::vector<float>& positions,
+                         std::vector<std::uint32_t>& indices);
@@ -1,11 +1,29 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
+#include "camera.h"
+#include "frame_pacer.h"
+#include "gpu_timer.h"
+#include "replay.h"
+#include "terrain_edit.h"
+
 struct GLFWwindow;  // forward declaration
 
 class Window {
   public:
     // Create a window and OpenGL context
     bool Create(int width = 800, int height = 600, const char* title = "OpenGL Terrain");
+    // Presentation mode and frame limiter; applied when the window is created
+    void SetPresentOptions(const PresentOptions& options) {
+        presentOptions = options;
+    }
+    // Record camera input to `path`, saved when the main loop exits
+    void RecordTo(const std::string& path);
+    // Drive the camera from a recording instead of live input, capture per-frame timings to
+    // `timingsPath` and close the window when the recording ends
+    bool ReplayFrom(const std::string& path, const std::string& timingsPath);
     // Main loop
     void Run();
     // Access to the native GLFW window pointer
@@ -17,5 +35,29 @@ class Window {
     GLFWwindow* window = nullptr;
     bool mouseCaptured = false;
     double lastMouseX = 0.0, lastMouseY = 0.0;
+    PresentOptions presentOptions;
+    FramePacer pacer;
+
+    // Input recording and replay
+    std::string recordPath;
+    std::string timingsPath;
+    Recording recording;
+    bool replaying = false;
+    std::size_t replayFrame = 0;
+    std::vector<FrameTiming> timings;
+    GpuTimer gpuTimer;
+
+    // Terrain brush, stamped along the cursor's path while the left mouse button is held
+    bool terrainEditing = false;
+    Brush brush;
+    int brushStampsPerFrame = 1;
+    bool brushStroking = false;
+    float brushLastX = 0.0f, brushLastZ = 0.0f;
+
     void ToggleMouseCapture(bool capture);
+    FrameInput PollInput();
+    void FinishReplay(float maxDrift);
+    // Placeholder frame while the renderer is still loading
+    void RenderLoadingFrame();
+    void UpdateBrushStroke(bool pressed);
 };
\ No newline at end of file
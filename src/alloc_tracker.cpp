@@ -0,0 +1,313 @@
+#include "alloc_tracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace alloc {
+void RecordViolation(NoAllocScope* scope, std::size_t size);
+}  // namespace alloc
+
+namespace {
+
+constexpr int kMaxTags = 32;
+constexpr int kUntagged = 0;
+
+// Fixed table so the hooks never allocate. Slots are claimed once and never released.
+struct TagSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<std::uint64_t> frameAllocations{0};
+    std::atomic<std::uint64_t> frameBytes{0};
+    alloc::Counters lastFrame;  // main thread only, written by EndFrame
+    alloc::Counters total;      // main thread only
+};
+
+std::array<TagSlot, kMaxTags> tags;
+std::atomic<int> tagCount{1};
+std::mutex registerMutex;
+std::atomic<bool> assertOnViolation{false};
+std::atomic<std::uint64_t> totalViolations{0};
+int imguiTag = -1;
+
+thread_local int currentTag = kUntagged;
+thread_local alloc::NoAllocScope* noAllocScope = nullptr;
+thread_local bool inHook = false;
+
+int RegisterTag(const char* tag) {
+    const int count = tagCount.load(std::memory_order_acquire);
+    for (int i = 1; i < count; ++i) {
+        const char* name = tags[i].name.load(std::memory_order_relaxed);
+        if (name == tag || (name && std::strcmp(name, tag) == 0))
+            return i;
+    }
+    std::lock_guard<std::mutex> lock(registerMutex);
+    const int locked = tagCount.load(std::memory_order_relaxed);
+    for (int i = count; i < locked; ++i) {
+        if (std::strcmp(tags[i].name.load(std::memory_order_relaxed), tag) == 0)
+            return i;
+    }
+    if (locked == kMaxTags)
+        return kUntagged;
+    tags[locked].name.store(tag, std::memory_order_relaxed);
+    tagCount.store(locked + 1, std::memory_order_release);
+    return locked;
+}
+
+void Record(int tag, std::size_t size) {
+    if (inHook)
+        return;
+    inHook = true;
+    tags[tag].frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    tags[tag].frameBytes.fetch_add(size, std::memory_order_relaxed);
+    if (noAllocScope)
+        alloc::RecordViolation(noAllocScope, size);
+    inHook = false;
+}
+
+void* TrackedAlloc(std::size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr)
+        Record(currentTag, size);
+    return ptr;
+}
+
+void* TrackedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, align < sizeof(void*) ? sizeof(void*) : align, size ? size : 1) != 0)
+        ptr = nullptr;
+#endif
+    if (ptr)
+        Record(currentTag, size);
+    return ptr;
+}
+
+void AlignedFree(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+}  // namespace
+
+namespace alloc {
+
+Scope::Scope(const char* tag) : previous(currentTag) {
+    currentTag = RegisterTag(tag);
+}
+
+Scope::~Scope() {
+    currentTag = previous;
+}
+
+void RecordViolation(NoAllocScope* scope, std::size_t size) {
+    totalViolations.fetch_add(1, std::memory_order_relaxed);
+    // Enclosing scopes see the violation too; the outermost one names it
+    for (;; scope = scope->parent) {
+        scope->violations.fetch_add(1, std::memory_order_relaxed);
+        if (!scope->parent)
+            break;
+    }
+    if (assertOnViolation.load(std::memory_order_relaxed)) {
+        std::fprintf(stderr,
+                     "Allocation of %zu bytes inside no-allocation scope '%s'\n",
+                     size,
+                     scope->name);
+        std::abort();
+    }
+}
+
+NoAllocScope::NoAllocScope(const char* name) : name(name), parent(noAllocScope) {
+    noAllocScope = this;
+}
+
+NoAllocScope::~NoAllocScope() {
+    noAllocScope = parent;
+}
+
+std::uint64_t NoAllocScope::Violations() const {
+    return violations.load(std::memory_order_relaxed);
+}
+
+NoAllocScope* CurrentNoAllocScope() {
+    return noAllocScope;
+}
+
+InheritNoAllocScope::InheritNoAllocScope(NoAllocScope* scope) : previous(noAllocScope) {
+    noAllocScope = scope;
+}
+
+InheritNoAllocScope::~InheritNoAllocScope() {
+    noAllocScope = previous;
+}
+
+void SetAssertOnViolation(bool enabled) {
+    assertOnViolation.store(enabled, std::memory_order_relaxed);
+}
+
+void EndFrame() {
+    const int count = tagCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        TagSlot& slot = tags[i];
+        slot.lastFrame.allocations = slot.frameAllocations.exchange(0, std::memory_order_relaxed);
+        slot.lastFrame.bytes = slot.frameBytes.exchange(0, std::memory_order_relaxed);
+        slot.total.allocations += slot.lastFrame.allocations;
+        slot.total.bytes += slot.lastFrame.bytes;
+    }
+}
+
+Counters LastFrame() {
+    Counters sum;
+    const int count = tagCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        sum.allocations += tags[i].lastFrame.allocations;
+        sum.bytes += tags[i].lastFrame.bytes;
+    }
+    return sum;
+}
+
+Counters Total() {
+    Counters sum;
+    const int count = tagCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        sum.allocations += tags[i].total.allocations;
+        sum.bytes += tags[i].total.bytes;
+    }
+    return sum;
+}
+
+std::size_t GetReports(TagReport* out, std::size_t maxReports) {
+    const auto count = static_cast<std::size_t>(tagCount.load(std::memory_order_acquire));
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < count && written < maxReports; ++i) {
+        const char* name = i == kUntagged ? "untagged" : tags[i].name.load();
+        out[written++] = {name, tags[i].lastFrame, tags[i].total};
+    }
+    return written;
+}
+
+void* ImGuiAlloc(std::size_t size, void* /*userData*/) {
+    if (imguiTag < 0)
+        imguiTag = RegisterTag("ImGui");
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr)
+        Record(imguiTag, size);
+    return ptr;
+}
+
+void ImGuiFree(void* ptr, void* /*userData*/) {
+    std::free(ptr);
+}
+
+}  // namespace alloc
+
+// Global allocation hooks
+
+void* operator new(std::size_t size) {
+    if (void* ptr = TrackedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = TrackedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept {
+    return TrackedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& /*tag*/) noexcept {
+    return TrackedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = TrackedAlignedAlloc(size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = TrackedAlignedAlloc(size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t& /*tag*/) noexcept {
+    return TrackedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t& /*tag*/) noexcept {
+    return TrackedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t& /*tag*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t& /*tag*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t /*alignment*/) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t /*alignment*/) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr,
+                     std::align_val_t /*alignment*/,
+                     const std::nothrow_t& /*tag*/) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr,
+                       std::align_val_t /*alignment*/,
+                       const std::nothrow_t& /*tag*/) noexcept {
+    AlignedFree(ptr);
+}
+
+#endif  // TRACK_ALLOCATIONS
@@ -0,0 +1,669 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "camera.h"
+#include "frame_arena.h"
+#include "heightfield.h"
+#include "jobs.h"
+#include "logger.h"
+#include "occlusion.h"
+#include "terrain_mesher.h"
+#include "terrain_raycast.h"
+#include "terrain_scene.h"
+#include "terrain_tiles.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Paths documented as allocation-free fail the benchmark if they allocate
+bool CheckNoAllocations(const alloc::NoAllocScope& scope, const char* what) {
+    if (scope.Violations() == 0)
+        return true;
+    LOG_ERROR("[bench] %s allocated %llu times inside a no-allocation scope",
+              what,
+              static_cast<unsigned long long>(scope.Violations()));
+    return false;
+}
+
+void LogAllocations() {
+#ifdef TRACK_ALLOCATIONS
+    alloc::EndFrame();
+    alloc::TagReport reports[32];
+    const std::size_t count = alloc::GetReports(reports, 32);
+    for (std::size_t i = 0; i < count; ++i) {
+        LOG_INFO("[bench] allocations [%s]: %llu allocs, %llu bytes",
+                 reports[i].name,
+                 static_cast<unsigned long long>(reports[i].total.allocations),
+                 static_cast<unsigned long long>(reports[i].total.bytes));
+    }
+#endif
+}
+
+// Picking-style rays: from above the terrain, angled down towards random ground points
+int RunRaycast() {
+    Heightfield field;
+    field.Generate(256, 0.2f);
+    TerrainRaycaster raycaster;
+    const auto buildStart = Clock::now();
+    raycaster.Build(field);
+    LOG_INFO("[bench] raycast: pyramid build %.3f ms", SecondsSince(buildStart) * 1000.0);
+
+    const std::size_t rayCount = 1 << 16;
+    const float extent = (field.Size() - 1) * field.CellSize() * 0.5f;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> onGround(-extent, extent);
+    std::uniform_real_distribution<float> height(2.5f, 8.0f);
+    std::vector<Ray> rays(rayCount);
+    for (auto& ray : rays) {
+        ray.originX = onGround(rng);
+        ray.originY = height(rng);
+        ray.originZ = onGround(rng);
+        ray.dirX = onGround(rng) - ray.originX;
+        ray.dirY = field.MinHeight() - ray.originY;
+        ray.dirZ = onGround(rng) - ray.originZ;
+        const float len =
+            std::sqrt(ray.dirX * ray.dirX + ray.dirY * ray.dirY + ray.dirZ * ray.dirZ);
+        ray.dirX /= len;
+        ray.dirY /= len;
+        ray.dirZ /= len;
+    }
+    std::vector<RayHit> hits(rayCount);
+
+    const auto singleStart = Clock::now();
+    for (std::size_t i = 0; i < rayCount; ++i) {
+        hits[i] = raycaster.Cast(rays[i]);
+    }
+    const double singleSeconds = SecondsSince(singleStart);
+
+    const int iterations = 10;
+    const auto batchStart = Clock::now();
+    {
+        alloc::NoAllocScope noAlloc("TerrainRaycaster::CastBatch");
+        for (int i = 0; i < iterations; ++i) {
+            raycaster.CastBatch(rays.data(), hits.data(), rayCount);
+        }
+        if (!CheckNoAllocations(noAlloc, "CastBatch"))
+            return 1;
+    }
+    const double batchSeconds = SecondsSince(batchStart) / iterations;
+
+    std::size_t hitCount = 0;
+    for (const auto& hit : hits) {
+        hitCount += hit.hit ? 1 : 0;
+    }
+    LOG_INFO("[bench] raycast: %zu rays, %.1f%% hit", rayCount, 100.0 * hitCount / rayCount);
+    LOG_INFO("[bench] raycast: single thread %.2f Mrays/s",
+             rayCount / singleSeconds / 1.0e6);
+    LOG_INFO("[bench] raycast: batched (%u workers + caller) %.2f Mrays/s",
+             jobs::WorkerCount(),
+             rayCount / batchSeconds / 1.0e6);
+    return 0;
+}
+
+// Batched bilinear height/normal queries against scalar calls
+int RunHeights() {
+    Heightfield field;
+    field.Generate(256, 0.2f);
+
+    const std::size_t count = 1 << 20;
+    const float extent = (field.Size() - 1) * field.CellSize() * 0.5f;
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> pos(-extent * 1.05f, extent * 1.05f);
+    std::vector<float> xs(count), zs(count), scalar(count), batched(count);
+    std::vector<float> nx(count), ny(count), nz(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = pos(rng);
+        zs[i] = pos(rng);
+    }
+    // Non-finite positions must land on the grid the same way in both paths
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const float special[][2] = {{nan, 0.0f}, {0.0f, nan}, {nan, nan}, {inf, 0.0f},
+                                {0.0f, -inf}, {-inf, inf}, {nan, inf}, {-inf, nan}};
+    for (std::size_t i = 0; i < std::size(special); ++i) {
+        xs[i] = special[i][0];
+        zs[i] = special[i][1];
+    }
+
+    const auto scalarStart = Clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        scalar[i] = field.SampleHeight(xs[i], zs[i]);
+    }
+    const double scalarSeconds = SecondsSince(scalarStart);
+
+    const int iterations = 10;
+    double batchSeconds = 0.0;
+    double normalSeconds = 0.0;
+    {
+        alloc::NoAllocScope noAlloc("Heightfield batch queries");
+        const auto batchStart = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            field.SampleHeights(xs.data(), zs.data(), batched.data(), count);
+        }
+        batchSeconds = SecondsSince(batchStart) / iterations;
+
+        const auto normalStart = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            field.SampleNormals(xs.data(), zs.data(), nx.data(), ny.data(), nz.data(), count);
+        }
+        normalSeconds = SecondsSince(normalStart) / iterations;
+        if (!CheckNoAllocations(noAlloc, "SampleHeights/SampleNormals"))
+            return 1;
+    }
+
+    float maxError = 0.0f;
+    bool finite = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        maxError = std::max(maxError, std::fabs(scalar[i] - batched[i]));
+        float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+        field.SampleNormal(xs[i], zs[i], sx, sy, sz);
+        maxError = std::max(maxError, std::fabs(sx - nx[i]) + std::fabs(sy - ny[i]) +
+                                          std::fabs(sz - nz[i]));
+        // std::max drops NaN differences, so check the results themselves
+        finite = finite && std::isfinite(scalar[i] + batched[i] + sx + sy + sz) &&
+                 std::isfinite(nx[i] + ny[i] + nz[i]);
+    }
+    LOG_INFO("[bench] heights: scalar %.1f M/s, batched %.1f M/s, normals %.1f M/s",
+             count / scalarSeconds / 1.0e6,
+             count / batchSeconds / 1.0e6,
+             count / normalSeconds / 1.0e6);
+    LOG_INFO("[bench] heights: max batch/scalar difference %g", maxError);
+    if (!finite || maxError > 1e-4f) {
+        LOG_ERROR("[bench] heights: batched results diverge from scalar");
+        return 1;
+    }
+    return 0;
+}
+
+// Occlusion culling of terrain tiles from random low cameras looking across the terrain.
+// Culled tiles are checked against the raycaster: no sampled surface point of a culled tile
+// may be directly visible from the camera.
+int RunOcclusion() {
+    Heightfield field;
+    field.Generate(TerrainScene::kVertsPerSide, TerrainScene::kCellSize);
+    TerrainRaycaster raycaster;
+    raycaster.Build(field);
+    // Same tiling as the renderer
+    const std::vector<TerrainTile> tiles = BuildTerrainTiles(field, TerrainScene::kTileCells);
+    std::vector<float> positions;
+    std::vector<std::uint32_t> indices;
+    AppendTileOccluders(BuildTerrainTiles(field, TerrainScene::kOccluderTileCells),
+                        field.MinHeight(),
+                        positions,
+                        indices);
+    std::vector<Bounds> bounds;
+    for (const TerrainTile& tile : tiles) {
+        bounds.push_back(tile.bounds);
+    }
+
+    const int viewCount = 256;
+    const float extent = (field.Size() - 1) * field.CellSize() * 0.5f;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> onGround(-extent * 0.9f, extent * 0.9f);
+    std::uniform_real_distribution<float> clearance(0.3f, 2.0f);
+    std::uniform_real_distribution<float> yaw(-3.14159f, 3.14159f);
+    std::uniform_real_distribution<float> pitch(-0.1f, 0.4f);
+    std::vector<Camera> cameras(viewCount);
+    std::vector<float> viewProjs(static_cast<std::size_t>(viewCount) * 16);
+    float projection[16];
+    BuildProjectionMatrix(kCameraFovY, 16.0f / 9.0f, kCameraNear, kCameraFar, projection);
+    for (int i = 0; i < viewCount; ++i) {
+        Camera& camera = cameras[i];
+        camera.x = onGround(rng);
+        camera.z = onGround(rng);
+        camera.y = field.SampleHeight(camera.x, camera.z) + clearance(rng);
+        camera.yaw = yaw(rng);
+        camera.pitch = pitch(rng);
+        float view[16];
+        BuildViewMatrix(camera, view);
+        MultiplyMatrices(projection, view, &viewProjs[static_cast<std::size_t>(i) * 16]);
+    }
+
+    OcclusionCuller culler;
+    std::vector<std::uint8_t> frustumVisible(tiles.size()), visible(tiles.size());
+    std::size_t frustumCount = 0, visibleCount = 0, falseCulls = 0;
+    double rasterSeconds = 0.0, testSeconds = 0.0;
+    // First view warms up the culler's buffers; everything after must not allocate
+    culler.BeginFrame(viewProjs.data(), 0.1f);
+    culler.RasterizeOccluders(
+        positions.data(), positions.size() / 3, indices.data(), indices.size() / 3);
+    alloc::NoAllocScope noAlloc("OcclusionCuller");
+    for (int i = 0; i < viewCount; ++i) {
+        const float* viewProj = &viewProjs[static_cast<std::size_t>(i) * 16];
+        culler.BeginFrame(viewProj, 0.1f);
+        culler.TestVisibility(bounds.data(), frustumVisible.data(), bounds.size());
+
+        const auto rasterStart = Clock::now();
+        culler.BeginFrame(viewProj, 0.1f);
+        culler.RasterizeOccluders(
+            positions.data(), positions.size() / 3, indices.data(), indices.size() / 3);
+        rasterSeconds += SecondsSince(rasterStart);
+        const auto testStart = Clock::now();
+        culler.TestVisibility(bounds.data(), visible.data(), bounds.size());
+        testSeconds += SecondsSince(testStart);
+
+        const Camera& camera = cameras[i];
+        for (std::size_t t = 0; t < tiles.size(); ++t) {
+            frustumCount += frustumVisible[t];
+            visibleCount += visible[t];
+            if (!frustumVisible[t] || visible[t])
+                continue;
+            // Sample the culled tile's surface and look for a point the camera sees directly
+            const TerrainTile& tile = tiles[t];
+            for (int sz = 0; sz <= tile.cells; sz += 4) {
+                for (int sx = 0; sx <= tile.cells; sx += 4) {
+                    const float px = field.OriginX() + (tile.cellX + sx) * field.CellSize();
+                    const float pz = field.OriginZ() + (tile.cellZ + sz) * field.CellSize();
+                    const float py = field.At(tile.cellX + sx, tile.cellZ + sz);
+                    Ray ray{camera.x,
+                            camera.y,
+                            camera.z,
+                            px - camera.x,
+                            py - camera.y,
+                            pz - camera.z};
+                    const float dist =
+                        std::sqrt(ray.dirX * ray.dirX + ray.dirY * ray.dirY + ray.dirZ * ray.dirZ);
+                    ray.dirX /= dist;
+                    ray.dirY /= dist;
+                    ray.dirZ /= dist;
+                    const RayHit hit = raycaster.Cast(ray, dist * 2.0f);
+                    if (hit.hit && hit.t >= dist * 0.999f - 1e-3f) {
+                        // Only points inside the view count; the tile box may straddle the edge
+                        float clip[4];
+                        const float* m = viewProj;
+                        for (int r = 0; r < 4; ++r) {
+                            clip[r] = m[r] * px + m[4 + r] * py + m[8 + r] * pz + m[12 + r];
+                        }
+                        if (clip[3] > 0.1f && std::fabs(clip[0]) <= clip[3] &&
+                            std::fabs(clip[1]) <= clip[3] && clip[2] <= clip[3])
+                            ++falseCulls;
+                    }
+                }
+            }
+        }
+    }
+    if (!CheckNoAllocations(noAlloc, "OcclusionCuller"))
+        return 1;
+
+    const double total = static_cast<double>(tiles.size()) * viewCount;
+    LOG_INFO("[bench] occlusion: %zu tiles, %zu occluder triangles, %d views",
+             tiles.size(),
+             indices.size() / 3,
+             viewCount);
+    LOG_INFO("[bench] occlusion: frustum culls %.1f%%, frustum + occlusion culls %.1f%%",
+             100.0 * (1.0 - frustumCount / total),
+             100.0 * (1.0 - visibleCount / total));
+    LOG_INFO("[bench] occlusion: %.1f%% of frustum-visible tiles hidden by occluders",
+             frustumCount > 0 ? 100.0 * (frustumCount - visibleCount) / frustumCount : 0.0);
+    LOG_INFO("[bench] occlusion: rasterize %.3f ms, test %.3f ms per view (%u workers + caller)",
+             rasterSeconds * 1000.0 / viewCount,
+             testSeconds * 1000.0 / viewCount,
+             jobs::WorkerCount());
+    if (falseCulls > 0) {
+        LOG_ERROR("[bench] occlusion: %zu visible surface samples in culled tiles", falseCulls);
+        return 1;
+    }
+    return 0;
+}
+
+// Adaptive terrain meshing: triangle reduction against the regular grid at a few tolerances.
+// Fails if the mesh has cracks (an edge used by a single triangle away from the border) or
+// does not cover the terrain.
+int RunMesh() {
+    Heightfield field;
+    field.Generate(TerrainScene::kVertsPerSide, TerrainScene::kCellSize);
+    const std::vector<TerrainTile> tiles = BuildTerrainTiles(field, TerrainScene::kTileCells);
+    const int size = field.Size();
+
+    TerrainMesher mesher;
+    const auto buildStart = Clock::now();
+    mesher.Build(field, TerrainScene::kTileCells);
+    LOG_INFO("[bench] mesh: error map %.3f ms", SecondsSince(buildStart) * 1000.0);
+
+    std::vector<std::uint32_t> regular;
+    for (const TerrainTile& tile : tiles) {
+        AppendRegularTile(tile, size, regular);
+    }
+    const std::size_t regularTriangles = regular.size() / 3;
+
+    std::vector<std::vector<std::uint32_t>> tileIndices(tiles.size());
+    for (float maxError : {0.0f, 0.005f, 0.02f, 0.05f, kMaxTerrainMeshError}) {
+        const auto meshStart = Clock::now();
+        jobs::ParallelFor(tiles.size(), 4, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                tileIndices[i].clear();
+                mesher.AppendTile(tiles[i], maxError, tileIndices[i]);
+            }
+        });
+        const double meshSeconds = SecondsSince(meshStart);
+
+        std::vector<std::uint32_t> indices;
+        for (const auto& tile : tileIndices) {
+            indices.insert(indices.end(), tile.begin(), tile.end());
+        }
+        const std::size_t triangles = indices.size() / 3;
+
+        // Every edge inside the terrain must be shared by exactly two triangles, and the
+        // triangles must cover the whole grid
+        std::vector<std::uint64_t> edges;
+        edges.reserve(indices.size());
+        double area = 0.0;
+        float maxDeviation = 0.0f;
+        for (std::size_t t = 0; t < triangles; ++t) {
+            const std::uint32_t* tri = &indices[t * 3];
+            for (int e = 0; e < 3; ++e) {
+                const std::uint64_t a = tri[e], b = tri[(e + 1) % 3];
+                edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+            }
+            const int ax = tri[0] % size, az = tri[0] / size;
+            const int bx = tri[1] % size, bz = tri[1] / size;
+            const int cx = tri[2] % size, cz = tri[2] / size;
+            const double doubleArea = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+            area += std::fabs(doubleArea) * 0.5;
+
+            // Vertical distance of the grid vertices the triangle covers to its plane
+            for (int z = std::min({az, bz, cz}); z <= std::max({az, bz, cz}); ++z) {
+                for (int x = std::min({ax, bx, cx}); x <= std::max({ax, bx, cx}); ++x) {
+                    const double w0 = ((bx - x) * (cz - z) - (bz - z) * (cx - x)) / doubleArea;
+                    const double w1 = ((cx - x) * (az - z) - (cz - z) * (ax - x)) / doubleArea;
+                    const double w2 = 1.0 - w0 - w1;
+                    if (w0 < -1e-9 || w1 < -1e-9 || w2 < -1e-9)
+                        continue;
+                    const double interpolated =
+                        w0 * field.At(ax, az) + w1 * field.At(bx, bz) + w2 * field.At(cx, cz);
+                    maxDeviation = std::max(
+                        maxDeviation, static_cast<float>(std::fabs(interpolated - field.At(x, z))));
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        std::size_t cracks = 0;
+        for (std::size_t i = 0; i < edges.size();) {
+            std::size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i]) {
+                ++j;
+            }
+            const int ax = static_cast<int>(edges[i] >> 32) % size;
+            const int az = static_cast<int>(edges[i] >> 32) / size;
+            const int bx = static_cast<int>(edges[i] & 0xffffffffu) % size;
+            const int bz = static_cast<int>(edges[i] & 0xffffffffu) / size;
+            const bool border = (ax == bx && (ax == 0 || ax == size - 1)) ||
+                                (az == bz && (az == 0 || az == size - 1));
+            if (j - i != (border ? 1u : 2u))
+                ++cracks;
+            i = j;
+        }
+        const double gridArea = static_cast<double>(size - 1) * (size - 1);
+
+        LOG_INFO("[bench] mesh: max error %.3f: %zu triangles (%.1f%% of %zu, %.1fx fewer), "
+                 "measured max error %.4f, %.3f ms",
+                 maxError,
+                 triangles,
+                 100.0 * triangles / regularTriangles,
+                 regularTriangles,
+                 static_cast<double>(regularTriangles) / triangles,
+                 maxDeviation,
+                 meshSeconds * 1000.0);
+        if (cracks > 0 || std::fabs(area - gridArea) > 1e-6) {
+            LOG_ERROR("[bench] mesh: %zu bad edges, area %.1f of %.1f", cracks, area, gridArea);
+            return 1;
+        }
+        // Small slack for float rounding in the plane evaluation
+        if (maxDeviation > maxError + 1e-5f) {
+            LOG_ERROR("[bench] mesh: measured error %.4f exceeds the tolerance %.3f",
+                      maxDeviation,
+                      maxError);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Terrain editing: frames of many brush stamps each, flushed once per frame. Checks that the
+// incremental updates match a rebuild from scratch and that the upload spans cover every change.
+int RunEdit() {
+    TerrainScene scene;
+    scene.Build(TerrainScene::kVertsPerSide, TerrainScene::kCellSize);
+    const Heightfield& field = scene.GetHeightfield();
+    const int size = field.Size();
+    const float extent = (size - 1) * field.CellSize() * 0.5f;
+    // What the GPU would hold: heights copied over only through the update's vertex spans
+    std::vector<float> uploaded(field.Data(), field.Data() + static_cast<std::size_t>(size) * size);
+
+    constexpr int kFrames = 120;
+    constexpr int kStampsPerFrame = 100;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> onGround(-extent, extent);
+    std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> radius(0.3f, 2.0f);
+    Brush brush;
+    brush.strength = 0.002f;
+    float x = 0.0f, z = 0.0f;
+
+    double stampSeconds = 0.0, flushSeconds = 0.0, worstFlushMs = 0.0;
+    std::size_t uploadCalls = 0, uploadBytes = 0, relayouts = 0, tilesRemeshed = 0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        // A new stroke every ten frames: new place, mode and size
+        if (frame % 10 == 0) {
+            x = onGround(rng);
+            z = onGround(rng);
+            brush.mode = static_cast<BrushMode>((frame / 10) % 3);
+            brush.radius = radius(rng);
+            brush.height = field.SampleHeight(x, z);
+        }
+        const auto stampStart = Clock::now();
+        for (int i = 0; i < kStampsPerFrame; ++i) {
+            x = std::clamp(x + step(rng) * 0.1f, -extent, extent);
+            z = std::clamp(z + step(rng) * 0.1f, -extent, extent);
+            brush.x = x;
+            brush.z = z;
+            scene.ApplyBrush(brush);
+        }
+        stampSeconds += SecondsSince(stampStart);
+
+        const auto flushStart = Clock::now();
+        const TerrainUpdate& update = scene.FlushEdits();
+        const double flushMs = SecondsSince(flushStart) * 1000.0;
+        flushSeconds += flushMs / 1000.0;
+        worstFlushMs = std::max(worstFlushMs, flushMs);
+        tilesRemeshed += update.tilesRemeshed;
+
+        for (const BufferSpan& span : update.vertexSpans) {
+            std::copy(field.Data() + span.first,
+                      field.Data() + span.first + span.count,
+                      uploaded.begin() + span.first);
+            uploadBytes += span.count * 6 * sizeof(float);
+        }
+        uploadCalls += update.vertexSpans.size() + update.indexSpans.size();
+        for (const BufferSpan& span : update.indexSpans) {
+            uploadBytes += span.count * sizeof(std::uint32_t);
+        }
+        if (update.indicesRelaid) {
+            ++uploadCalls;
+            ++relayouts;
+            uploadBytes += scene.MeshIndices().size() * sizeof(std::uint32_t);
+        }
+    }
+
+    const double stamps = static_cast<double>(kFrames) * kStampsPerFrame;
+    const double fullUploadBytes = static_cast<double>(size) * size * 6 * sizeof(float) +
+                                   scene.MeshIndices().size() * sizeof(std::uint32_t);
+    LOG_INFO("[bench] edit: %.0f stamps, %.2f us per stamp (%.0f stamps/s)",
+             stamps,
+             stampSeconds * 1e6 / stamps,
+             stamps / stampSeconds);
+    LOG_INFO("[bench] edit: flush %.3f ms avg, %.3f ms worst, %.1f tiles remeshed per frame",
+             flushSeconds * 1000.0 / kFrames,
+             worstFlushMs,
+             static_cast<double>(tilesRemeshed) / kFrames);
+    LOG_INFO("[bench] edit: %.1f upload calls and %.1f KB per frame (full re-upload %.1f KB), "
+             "%zu index relayouts",
+             static_cast<double>(uploadCalls) / kFrames,
+             uploadBytes / 1024.0 / kFrames,
+             fullUploadBytes / 1024.0,
+             relayouts);
+
+    int failures = 0;
+    if (!std::equal(uploaded.begin(), uploaded.end(), field.Data())) {
+        LOG_ERROR("[bench] edit: vertex spans missed changed heights");
+        ++failures;
+    }
+
+    // Everything derived incrementally must match a rebuild from the final heights
+    const std::vector<TerrainTile> rebuiltTiles =
+        BuildTerrainTiles(field, TerrainScene::kTileCells);
+    TerrainMesher rebuiltMesher;
+    rebuiltMesher.Build(field, TerrainScene::kTileCells);
+    const std::vector<std::uint32_t>& indices = scene.MeshIndices();
+    std::uint32_t expectedFirst = 0;
+    std::vector<std::uint32_t> tileIndices;
+    for (std::size_t i = 0; i < rebuiltTiles.size(); ++i) {
+        const TerrainTile& tile = scene.Tiles()[i];
+        if (tile.minHeight != rebuiltTiles[i].minHeight ||
+            tile.maxHeight != rebuiltTiles[i].maxHeight) {
+            LOG_ERROR("[bench] edit: tile %zu has stale bounds", i);
+            ++failures;
+        }
+        const TileMesh& mesh = scene.TileMeshes()[i];
+        tileIndices.clear();
+        rebuiltMesher.AppendTile(rebuiltTiles[i], scene.MeshMaxError(), tileIndices);
+        const bool sameTriangles =
+            mesh.indexCount == tileIndices.size() &&
+            std::equal(tileIndices.begin(), tileIndices.end(), indices.begin() + mesh.firstIndex);
+        // Padding must be degenerate, and ranges contiguous so runs of tiles merge into one draw
+        const bool paddingDegenerate = std::all_of(
+            indices.begin() + mesh.firstIndex + mesh.indexCount,
+            indices.begin() + mesh.firstIndex + mesh.capacity,
+            [&](std::uint32_t index) { return index == indices[mesh.firstIndex]; });
+        if (!sameTriangles || !paddingDegenerate || mesh.firstIndex != expectedFirst) {
+            LOG_ERROR("[bench] edit: tile %zu mesh differs from a rebuild", i);
+            ++failures;
+        }
+        expectedFirst = mesh.firstIndex + mesh.capacity;
+    }
+
+    TerrainRaycaster rebuiltRaycaster;
+    rebuiltRaycaster.Build(field);
+    for (int i = 0; i < 2000; ++i) {
+        const Ray ray{onGround(rng), 6.0f, onGround(rng), step(rng), -1.0f, step(rng)};
+        const RayHit a = scene.GetRaycaster().Cast(ray);
+        const RayHit b = rebuiltRaycaster.Cast(ray);
+        if (a.hit != b.hit || a.t != b.t) {
+            LOG_ERROR("[bench] edit: picking differs from a rebuilt pyramid");
+            ++failures;
+            break;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Frames that only use per-frame memory: logging, a copy of the recent log lines, pmr containers
+// on the frame arena and ParallelFor chunks on the worker sub-arenas. Once the arenas have grown,
+// a frame must not touch the general heap.
+int RunArena() {
+    // Sized so one thread running every chunk still fits in a single arena block
+    constexpr std::size_t kItems = 1 << 13;
+    constexpr std::size_t kGrain = 256;
+    constexpr std::size_t kLogLines = 32;
+    constexpr std::size_t kBlockBytes = 64 * 1024;  // LinearArena's default block size
+    std::vector<float> input(kItems);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    for (float& v : input) {
+        v = value(rng);
+    }
+    std::vector<float> medians(kItems / kGrain);
+    std::size_t logLines = 0;
+
+    auto runFrame = [&](int index) {
+        frame::BeginFrame();
+        LOG_INFO("[bench] arena: frame %d", index);
+        const auto logs = logging::GetRecentLogs(kLogLines, frame::Resource());
+        logLines = logs.size();
+        std::pmr::vector<std::pmr::string> words(frame::Resource());
+        for (int i = 0; i < 64; ++i) {
+            words.emplace_back(logs.back()).append(" and a tail past the small-string buffer");
+        }
+        jobs::ParallelFor(kItems, kGrain, [&](std::size_t begin, std::size_t end) {
+            std::pmr::vector<float> scratch(
+                input.begin() + begin, input.begin() + end, frame::Resource());
+            std::sort(scratch.begin(), scratch.end());
+            medians[begin / kGrain] = scratch[scratch.size() / 2];
+        });
+    };
+
+    // Warm up until every thread has used both of its arenas, so each has its first block, and
+    // the log copy has reached its full length
+    const unsigned int workers = jobs::WorkerCount();
+    int frameIndex = 0;
+    for (bool warm = false; !warm && frameIndex < 1000; ++frameIndex) {
+        runFrame(frameIndex);
+        const frame::Stats stats = frame::GetStats();
+        warm = frameIndex >= 8 && logLines == kLogLines &&
+               stats.threads > static_cast<int>(workers) &&
+               stats.workerCapacity >= workers * 2 * kBlockBytes;
+    }
+
+    const int frames = 32;
+    const auto start = Clock::now();
+    {
+        alloc::NoAllocScope noAlloc("Frame arena steady state");
+        for (int i = 0; i < frames; ++i) {
+            runFrame(++frameIndex);
+        }
+        if (!CheckNoAllocations(noAlloc, "Steady-state frames"))
+            return 1;
+    }
+    const double seconds = SecondsSince(start);
+
+    const frame::Stats stats = frame::GetStats();
+    LOG_INFO("[bench] arena: %d frames after %d warm-up, %.3f ms/frame, %zu log lines copied",
+             frames,
+             frameIndex - frames,
+             seconds * 1000.0 / frames,
+             logLines);
+    LOG_INFO("[bench] arena: main %zu KB peak, workers %zu KB peak, %zu KB reserved",
+             stats.mainHighWater / 1024,
+             stats.workerHighWater / 1024,
+             (stats.mainCapacity + stats.workerCapacity) / 1024);
+    return 0;
+}
+
+}  // namespace
+
+namespace bench {
+
+int Run(const std::string& name) {
+    int result = 1;
+    if (name == "raycast")
+        result = RunRaycast();
+    else if (name == "heights")
+        result = RunHeights();
+    else if (name == "occlusion")
+        result = RunOcclusion();
+    else if (name == "mesh")
+        result = RunMesh();
+    else if (name == "edit")
+        result = RunEdit();
+    else if (name == "arena")
+        result = RunArena();
+    else
+        LOG_ERROR("Unknown benchmark '%s'", name.c_str());
+    LogAllocations();
+    return result;
+}
+
+}  // namespace bench
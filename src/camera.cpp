@@ -0,0 +1,116 @@
+#include "camera.h"
+
+#include <cmath>
+
+#include "heightfield.h"
+
+static constexpr float kMouseSensitivity = 0.002f;
+
+void ApplyInput(const FrameInput& input, const Heightfield& ground, Camera& camera) {
+    // Keyboard movement
+    float cosYaw = cosf(camera.yaw), sinYaw = sinf(camera.yaw);
+    float cosPitch = cosf(camera.pitch);
+    float frontX = cosYaw * cosPitch;
+    float frontZ = sinYaw * cosPitch;
+    float rightX = -sinYaw;
+    float rightZ = cosYaw;
+
+    if (input.keys & FrameInput::kForward) {
+        camera.x -= rightX * camera.speed;
+        camera.z -= rightZ * camera.speed;
+    }
+    if (input.keys & FrameInput::kBack) {
+        camera.x += rightX * camera.speed;
+        camera.z += rightZ * camera.speed;
+    }
+    if (input.keys & FrameInput::kLeft) {
+        camera.x -= frontX * camera.speed;
+        camera.z -= frontZ * camera.speed;
+    }
+    if (input.keys & FrameInput::kRight) {
+        camera.x += frontX * camera.speed;
+        camera.z += frontZ * camera.speed;
+    }
+    if (input.keys & FrameInput::kUp)
+        camera.y += camera.speed;
+    if (input.keys & FrameInput::kDown)
+        camera.y -= camera.speed;
+
+    // Keep the camera above the terrain surface
+    if (ground.Contains(camera.x, camera.z)) {
+        const float minY = ground.SampleHeight(camera.x, camera.z) + kCameraGroundClearance;
+        if (camera.y < minY)
+            camera.y = minY;
+    }
+
+    // Mouse look
+    camera.yaw += input.lookX * kMouseSensitivity;
+    camera.pitch += input.lookY * kMouseSensitivity;
+    if (camera.pitch > 1.5f)
+        camera.pitch = 1.5f;
+    if (camera.pitch < -1.5f)
+        camera.pitch = -1.5f;
+}
+
+void BuildViewMatrix(const Camera& camera, float out[16]) {
+    float cosYaw = std::cos(camera.yaw), sinYaw = std::sin(camera.yaw);
+    float cosPitch = std::cos(camera.pitch), sinPitch = std::sin(camera.pitch);
+
+    const float view[16] = {
+        cosYaw,
+        sinPitch * sinYaw,
+        -cosPitch * sinYaw,
+        0.0f,
+        0.0f,
+        cosPitch,
+        sinPitch,
+        0.0f,
+        sinYaw,
+        -sinPitch * cosYaw,
+        cosPitch * cosYaw,
+        0.0f,
+        -camera.x * cosYaw - camera.z * sinYaw,
+        -camera.x * sinPitch * sinYaw - camera.y * cosPitch + camera.z * sinPitch * cosYaw,
+        camera.x * cosPitch * sinYaw - camera.y * sinPitch - camera.z * cosPitch * cosYaw,
+        1.0f};
+    for (int i = 0; i < 16; ++i) {
+        out[i] = view[i];
+    }
+}
+
+void BuildProjectionMatrix(float fovY, float aspect, float zNear, float zFar, float out[16]) {
+    float f = 1.0f / std::tan(fovY * 0.5f);
+    float A = (zFar + zNear) / (zNear - zFar);
+    float B = (2.0f * zFar * zNear) / (zNear - zFar);
+    const float proj[16] = {f / aspect,
+                            0.0f,
+                            0.0f,
+                            0.0f,
+                            0.0f,
+                            f,
+                            0.0f,
+                            0.0f,
+                            0.0f,
+                            0.0f,
+                            A,
+                            -1.0f,
+                            0.0f,
+                            0.0f,
+                            B,
+                            0.0f};
+    for (int i = 0; i < 16; ++i) {
+        out[i] = proj[i];
+    }
+}
+
+void MultiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            out[col * 4 + row] = sum;
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+LinearArena::LinearArena(std::size_t blockSize) : blockSize(blockSize) {}
+
+LinearArena::~LinearArena() {
+    for (Block* block = head; block;) {
+        Block* next = block->next;
+        ::operator delete(block);
+        block = next;
+    }
+}
+
+void* LinearArena::Allocate(std::size_t size, std::size_t alignment) {
+    for (;;) {
+        if (current) {
+            const auto base = reinterpret_cast<std::uintptr_t>(current + 1);
+            const std::uintptr_t start =
+                (base + current->offset + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+            const std::size_t end = static_cast<std::size_t>(start - base) + size;
+            if (end <= current->size) {
+                used += end - current->offset;
+                current->offset = end;
+                return reinterpret_cast<void*>(start);
+            }
+            // Blocks kept from earlier frames are reused before growing
+            if (current->next) {
+                current = current->next;
+                continue;
+            }
+        }
+
+        alloc::Scope allocScope("FrameArena");
+        const std::size_t bytes = std::max(blockSize, size + alignment);
+        auto* block = static_cast<Block*>(::operator new(sizeof(Block) + bytes));
+        block->next = nullptr;
+        block->size = bytes;
+        block->offset = 0;
+        if (current)
+            current->next = block;
+        else
+            head = block;
+        current = block;
+        capacity += bytes;
+    }
+}
+
+void LinearArena::Reset() {
+    for (Block* block = head; block; block = block->next) {
+        block->offset = 0;
+    }
+    highWater = std::max(highWater, used);
+    used = 0;
+    current = head;
+}
+
+namespace {
+
+struct ThreadArenas {
+    LinearArena arenas[2];
+    ArenaResource resources[2] = {ArenaResource(arenas[0]), ArenaResource(arenas[1])};
+    std::uint64_t resetFrame[2] = {~std::uint64_t{0}, ~std::uint64_t{0}};
+    // Published on reset so other threads can read stats without racing the owner
+    std::atomic<std::size_t> highWater{0};
+    std::atomic<std::size_t> capacity{0};
+
+    ThreadArenas();
+    ~ThreadArenas();
+    ThreadArenas(const ThreadArenas&) = delete;
+    ThreadArenas& operator=(const ThreadArenas&) = delete;
+};
+
+std::atomic<std::uint64_t> currentFrame{0};
+std::mutex registryMutex;
+std::vector<ThreadArenas*> registry;
+std::atomic<ThreadArenas*> mainArenas{nullptr};
+
+ThreadArenas::ThreadArenas() {
+    alloc::Scope allocScope("FrameArena");
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(this);
+}
+
+ThreadArenas::~ThreadArenas() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    ThreadArenas* self = this;
+    mainArenas.compare_exchange_strong(self, nullptr);
+}
+
+ThreadArenas& Local() {
+    thread_local ThreadArenas arenas;
+    return arenas;
+}
+
+int CurrentSlot(ThreadArenas& local) {
+    const std::uint64_t frameIndex = currentFrame.load(std::memory_order_acquire);
+    const int slot = static_cast<int>(frameIndex & 1);
+    if (local.resetFrame[slot] != frameIndex) {
+        local.arenas[slot].Reset();
+        local.resetFrame[slot] = frameIndex;
+        local.highWater.store(
+            std::max(local.arenas[0].HighWater(), local.arenas[1].HighWater()),
+            std::memory_order_relaxed);
+        local.capacity.store(local.arenas[0].Capacity() + local.arenas[1].Capacity(),
+                             std::memory_order_relaxed);
+    }
+    return slot;
+}
+
+}  // namespace
+
+namespace frame {
+
+void BeginFrame() {
+    mainArenas.store(&Local(), std::memory_order_relaxed);
+    currentFrame.fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::uint64_t Index() {
+    return currentFrame.load(std::memory_order_acquire);
+}
+
+LinearArena& Arena() {
+    ThreadArenas& local = Local();
+    return local.arenas[CurrentSlot(local)];
+}
+
+std::pmr::memory_resource* Resource() {
+    ThreadArenas& local = Local();
+    return &local.resources[CurrentSlot(local)];
+}
+
+Stats GetStats() {
+    Stats stats;
+    stats.frame = Index();
+    ThreadArenas* main = mainArenas.load(std::memory_order_relaxed);
+    if (main == &Local()) {
+        const int previous = static_cast<int>((stats.frame + 1) & 1);
+        stats.mainUsed = main->arenas[previous].Used();
+        stats.mainCapacity = main->arenas[0].Capacity() + main->arenas[1].Capacity();
+        stats.mainHighWater = std::max(main->arenas[0].HighWater(), main->arenas[1].HighWater());
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    stats.threads = static_cast<int>(registry.size());
+    for (ThreadArenas* arenas : registry) {
+        if (arenas == main)
+            continue;
+        stats.workerHighWater =
+            std::max(stats.workerHighWater, arenas->highWater.load(std::memory_order_relaxed));
+        stats.workerCapacity += arenas->capacity.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+}  // namespace frame
@@ -0,0 +1,217 @@
+#include "frame_pacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "logger.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+namespace {
+
+// Frames this much longer than the target count as a missed deadline
+constexpr double kMissedFactor = 1.5;
+// Bounds for the adaptive spin window at the end of a limiter wait. The upper bound covers a
+// whole default Windows scheduler tick (15.6 ms) in case the timer resolution cannot be raised.
+constexpr auto kMinSpin = std::chrono::microseconds(200);
+constexpr auto kMaxSpin = std::chrono::microseconds(20000);
+
+bool AdaptiveSupported() {
+    return glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+           glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
+
+}  // namespace
+
+const char* PresentModeName(PresentMode mode) {
+    switch (mode) {
+        case PresentMode::kVsync:
+            return "vsync";
+        case PresentMode::kAdaptive:
+            return "adaptive";
+        case PresentMode::kUncapped:
+            return "uncapped";
+        case PresentMode::kLimited:
+            return "limited";
+    }
+    return "unknown";
+}
+
+bool ParsePresentMode(std::string_view name, PresentMode& mode) {
+    for (PresentMode m : {PresentMode::kVsync,
+                          PresentMode::kAdaptive,
+                          PresentMode::kUncapped,
+                          PresentMode::kLimited}) {
+        if (name == PresentModeName(m)) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+FramePacer::~FramePacer() {
+    SetFineTimer(false);
+}
+
+void FramePacer::Configure(const PresentOptions& newOptions) {
+    options = newOptions;
+    if (GLFWmonitor* monitor = glfwGetPrimaryMonitor()) {
+        if (const GLFWvidmode* videoMode = glfwGetVideoMode(monitor))
+            refreshRate = std::max(1, videoMode->refreshRate);
+    }
+    SetTargetFps(options.targetFps);
+    SetMode(options.mode);
+}
+
+void FramePacer::SetMode(PresentMode mode) {
+    if (mode == PresentMode::kAdaptive && !AdaptiveSupported()) {
+        LOG_WARN("Adaptive vsync (swap_control_tear) is not supported; using vsync");
+        mode = PresentMode::kVsync;
+    }
+    options.mode = mode;
+    SetFineTimer(mode == PresentMode::kLimited);
+    switch (mode) {
+        case PresentMode::kVsync:
+            glfwSwapInterval(1);
+            break;
+        case PresentMode::kAdaptive:
+            glfwSwapInterval(-1);
+            break;
+        case PresentMode::kUncapped:
+        case PresentMode::kLimited:
+            glfwSwapInterval(0);
+            break;
+    }
+    deadline = {};
+    if (mode == PresentMode::kLimited) {
+        LOG_INFO("Present mode: limited to %.1f FPS%s",
+                 options.targetFps,
+                 options.lowLatency ? " (low latency)" : "");
+    } else {
+        LOG_INFO("Present mode: %s (display %d Hz)", PresentModeName(mode), refreshRate);
+    }
+}
+
+void FramePacer::SetTargetFps(float fps) {
+    options.targetFps = std::clamp(fps, 1.0f, 1000.0f);
+    deadline = {};
+}
+
+void FramePacer::SetLowLatency(bool enabled) {
+    options.lowLatency = enabled;
+}
+
+void FramePacer::BeginFrame() {
+    if (options.mode == PresentMode::kLimited && options.lowLatency)
+        WaitForDeadline();
+}
+
+void FramePacer::BeforeSwap() {
+    if (options.mode == PresentMode::kLimited && !options.lowLatency)
+        WaitForDeadline();
+}
+
+void FramePacer::AfterSwap() {
+    const Clock::time_point now = Clock::now();
+    if (lastPresent != Clock::time_point{}) {
+        const double interval =
+            std::chrono::duration<double, std::milli>(now - lastPresent).count();
+        history[historyNext] = static_cast<float>(interval);
+        historyNext = (historyNext + 1) % kHistory;
+        historyCount = std::min(historyCount + 1, kHistory);
+        ++frames;
+        const double target = TargetMs();
+        if (target > 0.0 && interval > target * kMissedFactor)
+            ++missedTotal;
+    }
+    lastPresent = now;
+}
+
+PacingStats FramePacer::Stats() const {
+    PacingStats stats;
+    stats.targetMs = TargetMs();
+    stats.frames = frames;
+    stats.missedTotal = missedTotal;
+    stats.samples = historyCount;
+    if (historyCount == 0)
+        return stats;
+    double sum = 0.0, sumSquares = 0.0;
+    for (int i = 0; i < historyCount; ++i) {
+        const double ms = history[i];
+        sum += ms;
+        sumSquares += ms * ms;
+        stats.worstMs = std::max(stats.worstMs, ms);
+        if (stats.targetMs > 0.0 && ms > stats.targetMs * kMissedFactor)
+            ++stats.missed;
+    }
+    stats.averageMs = sum / historyCount;
+    stats.jitterMs =
+        std::sqrt(std::max(0.0, sumSquares / historyCount - stats.averageMs * stats.averageMs));
+    return stats;
+}
+
+double FramePacer::TargetMs() const {
+    switch (options.mode) {
+        case PresentMode::kVsync:
+        case PresentMode::kAdaptive:
+            return 1000.0 / refreshRate;
+        case PresentMode::kLimited:
+            return 1000.0 / options.targetFps;
+        case PresentMode::kUncapped:
+            break;
+    }
+    return 0.0;
+}
+
+void FramePacer::WaitForDeadline() {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.targetFps));
+    const Clock::time_point now = Clock::now();
+    // Keep a fixed cadence, catching up after a slightly late frame; resync after a long stall
+    // instead of rushing several frames out back to back
+    if (deadline == Clock::time_point{} || now - deadline > period)
+        deadline = now;
+    else
+        SleepUntil(deadline);
+    deadline += period;
+}
+
+void FramePacer::SetFineTimer(bool enabled) {
+    if (enabled == fineTimer)
+        return;
+    fineTimer = enabled;
+#ifdef _WIN32
+    // Windows wakes sleeping threads on a ~15.6 ms tick by default, which oversleeps most frame
+    // deadlines; 1 ms while the limiter is active keeps the sleep close to the spin window
+    if (enabled)
+        timeBeginPeriod(1);
+    else
+        timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SleepUntil(Clock::time_point until) {
+    const Clock::time_point wake = until - spinMargin;
+    if (Clock::now() < wake) {
+        std::this_thread::sleep_until(wake);
+        // Widen the spin window when the OS oversleeps, shrink it slowly when it is on time
+        const Clock::duration late = Clock::now() - wake;
+        if (late * 5 > spinMargin * 4)
+            spinMargin = std::min<Clock::duration>(late * 3 / 2, kMaxSpin);
+        else
+            spinMargin = std::max<Clock::duration>(spinMargin - spinMargin / 16, kMinSpin);
+    }
+    while (Clock::now() < until) {
+        std::this_thread::yield();
+    }
+}
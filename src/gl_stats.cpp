@@ -0,0 +1,436 @@
+#define GL_HOOKS_IMPLEMENTATION
+#include "gl_hooks.h"
+
+#ifdef TRACK_GL_CALLS
+
+#include <array>
+
+namespace {
+
+using glstats::CallCounters;
+using glstats::Category;
+
+enum Call {
+    kClear,
+    kDrawArrays,
+    kDrawElements,
+    kMultiDrawElements,
+    kBeginQuery,
+    kBindBuffer,
+    kBindVertexArray,
+    kClearColor,
+    kDisable,
+    kEnable,
+    kEnableVertexAttribArray,
+    kEndQuery,
+    kUniform3f,
+    kUniformMatrix4fv,
+    kUseProgram,
+    kVertexAttribPointer,
+    kViewport,
+    kBufferData,
+    kBufferSubData,
+    kCopyBufferSubData,
+    kMapBufferRange,
+    kUnmapBuffer,
+    kGetIntegerv,
+    kGetQueryObjectiv,
+    kGetQueryObjectui64v,
+    kGetString,
+    kGetUniformLocation,
+    kIsEnabled,
+    kAttachShader,
+    kCompileShader,
+    kCreateProgram,
+    kCreateShader,
+    kDeleteBuffers,
+    kDeleteQueries,
+    kGenBuffers,
+    kGenQueries,
+    kGenVertexArrays,
+    kLinkProgram,
+    kShaderSource,
+    kCallCount
+};
+
+struct CallInfo {
+    const char* name;
+    Category category;
+};
+
+// Indexed by Call
+constexpr std::array<CallInfo, kCallCount> kCalls = {{
+    {"glClear", Category::kDraw},
+    {"glDrawArrays", Category::kDraw},
+    {"glDrawElements", Category::kDraw},
+    {"glMultiDrawElements", Category::kDraw},
+    {"glBeginQuery", Category::kState},
+    {"glBindBuffer", Category::kState},
+    {"glBindVertexArray", Category::kState},
+    {"glClearColor", Category::kState},
+    {"glDisable", Category::kState},
+    {"glEnable", Category::kState},
+    {"glEnableVertexAttribArray", Category::kState},
+    {"glEndQuery", Category::kState},
+    {"glUniform3f", Category::kState},
+    {"glUniformMatrix4fv", Category::kState},
+    {"glUseProgram", Category::kState},
+    {"glVertexAttribPointer", Category::kState},
+    {"glViewport", Category::kState},
+    {"glBufferData", Category::kUpload},
+    {"glBufferSubData", Category::kUpload},
+    {"glCopyBufferSubData", Category::kUpload},
+    {"glMapBufferRange", Category::kUpload},
+    {"glUnmapBuffer", Category::kUpload},
+    {"glGetIntegerv", Category::kQuery},
+    {"glGetQueryObjectiv", Category::kQuery},
+    {"glGetQueryObjectui64v", Category::kQuery},
+    {"glGetString", Category::kQuery},
+    {"glGetUniformLocation", Category::kQuery},
+    {"glIsEnabled", Category::kQuery},
+    {"glAttachShader", Category::kObject},
+    {"glCompileShader", Category::kObject},
+    {"glCreateProgram", Category::kObject},
+    {"glCreateShader", Category::kObject},
+    {"glDeleteBuffers", Category::kObject},
+    {"glDeleteQueries", Category::kObject},
+    {"glGenBuffers", Category::kObject},
+    {"glGenQueries", Category::kObject},
+    {"glGenVertexArrays", Category::kObject},
+    {"glLinkProgram", Category::kObject},
+    {"glShaderSource", Category::kObject},
+}};
+
+struct CallSlot {
+    CallCounters frame;
+    CallCounters lastFrame;
+    CallCounters total;
+};
+
+// GL is only called from the main thread, so the counters are plain integers
+std::array<CallSlot, kCallCount> slots;
+
+// Queries make the driver return state to the caller, so a threaded driver has to drain its
+// command queue first; other calls pass `sync` when their arguments make them wait
+void Count(Call call, std::uint64_t bytes = 0, bool sync = false) {
+    CallCounters& counters = slots[call].frame;
+    ++counters.calls;
+    counters.bytes += bytes;
+    if (sync || kCalls[call].category == Category::kQuery)
+        ++counters.syncCalls;
+}
+
+void Accumulate(glstats::Counters& sum, Call call, const CallCounters& counters) {
+    sum.calls += counters.calls;
+    sum.syncCalls += counters.syncCalls;
+    switch (kCalls[call].category) {
+        case Category::kDraw:
+            sum.draws += counters.calls;
+            break;
+        case Category::kState:
+            sum.stateChanges += counters.calls;
+            break;
+        case Category::kUpload:
+            sum.uploads += counters.calls;
+            // Copies move bytes that were already counted when the source was written
+            if (call != kCopyBufferSubData)
+                sum.uploadBytes += counters.bytes;
+            break;
+        case Category::kQuery:
+            sum.queries += counters.calls;
+            break;
+        case Category::kObject:
+            sum.objects += counters.calls;
+            break;
+    }
+}
+
+template <typename Select>
+glstats::Counters Sum(Select select) {
+    glstats::Counters sum;
+    for (int i = 0; i < kCallCount; ++i) {
+        Accumulate(sum, static_cast<Call>(i), select(slots[i]));
+    }
+    return sum;
+}
+
+std::uint64_t Bytes(GLsizeiptr size) {
+    return size > 0 ? static_cast<std::uint64_t>(size) : 0;
+}
+
+}  // namespace
+
+namespace glstats {
+
+const char* CategoryName(Category category) {
+    switch (category) {
+        case Category::kDraw:
+            return "draw";
+        case Category::kState:
+            return "state";
+        case Category::kUpload:
+            return "upload";
+        case Category::kQuery:
+            return "query";
+        case Category::kObject:
+            return "object";
+    }
+    return "";
+}
+
+void EndFrame() {
+    for (CallSlot& slot : slots) {
+        slot.lastFrame = slot.frame;
+        slot.total.calls += slot.frame.calls;
+        slot.total.bytes += slot.frame.bytes;
+        slot.total.syncCalls += slot.frame.syncCalls;
+        slot.frame = {};
+    }
+}
+
+Counters CurrentFrame() {
+    return Sum([](const CallSlot& slot) { return slot.frame; });
+}
+
+Counters LastFrame() {
+    return Sum([](const CallSlot& slot) { return slot.lastFrame; });
+}
+
+Counters Total() {
+    return Sum([](const CallSlot& slot) { return slot.total; });
+}
+
+std::size_t GetReports(CallReport* out, std::size_t maxReports) {
+    std::size_t written = 0;
+    for (int i = 0; i < kCallCount && written < maxReports; ++i) {
+        const CallSlot& slot = slots[i];
+        if (slot.total.calls == 0 && slot.lastFrame.calls == 0)
+            continue;
+        out[written++] = {kCalls[i].name, kCalls[i].category, slot.lastFrame, slot.total};
+    }
+    return written;
+}
+
+}  // namespace glstats
+
+namespace glstats::hooks {
+
+void Clear(GLbitfield mask) {
+    Count(kClear);
+    glClear(mask);
+}
+
+void DrawArrays(GLenum mode, GLint first, GLsizei count) {
+    Count(kDrawArrays);
+    glDrawArrays(mode, first, count);
+}
+
+void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    Count(kDrawElements);
+    glDrawElements(mode, count, type, indices);
+}
+
+void MultiDrawElements(GLenum mode,
+                       const GLsizei* count,
+                       GLenum type,
+                       const void* const* indices,
+                       GLsizei drawcount) {
+    Count(kMultiDrawElements);
+    glMultiDrawElements(mode, count, type, indices, drawcount);
+}
+
+void BeginQuery(GLenum target, GLuint id) {
+    Count(kBeginQuery);
+    glBeginQuery(target, id);
+}
+
+void BindBuffer(GLenum target, GLuint buffer) {
+    Count(kBindBuffer);
+    glBindBuffer(target, buffer);
+}
+
+void BindVertexArray(GLuint array) {
+    Count(kBindVertexArray);
+    glBindVertexArray(array);
+}
+
+void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    Count(kClearColor);
+    glClearColor(red, green, blue, alpha);
+}
+
+void Disable(GLenum cap) {
+    Count(kDisable);
+    glDisable(cap);
+}
+
+void Enable(GLenum cap) {
+    Count(kEnable);
+    glEnable(cap);
+}
+
+void EnableVertexAttribArray(GLuint index) {
+    Count(kEnableVertexAttribArray);
+    glEnableVertexAttribArray(index);
+}
+
+void EndQuery(GLenum target) {
+    Count(kEndQuery);
+    glEndQuery(target);
+}
+
+void Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    Count(kUniform3f);
+    glUniform3f(location, v0, v1, v2);
+}
+
+void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    Count(kUniformMatrix4fv);
+    glUniformMatrix4fv(location, count, transpose, value);
+}
+
+void UseProgram(GLuint program) {
+    Count(kUseProgram);
+    glUseProgram(program);
+}
+
+void VertexAttribPointer(GLuint index,
+                         GLint size,
+                         GLenum type,
+                         GLboolean normalized,
+                         GLsizei stride,
+                         const void* pointer) {
+    Count(kVertexAttribPointer);
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    Count(kViewport);
+    glViewport(x, y, width, height);
+}
+
+void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    // Without data the call only allocates storage
+    Count(kBufferData, data ? Bytes(size) : 0);
+    glBufferData(target, size, data, usage);
+}
+
+void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    Count(kBufferSubData, Bytes(size));
+    glBufferSubData(target, offset, size, data);
+}
+
+void CopyBufferSubData(GLenum readTarget,
+                       GLenum writeTarget,
+                       GLintptr readOffset,
+                       GLintptr writeOffset,
+                       GLsizeiptr size) {
+    Count(kCopyBufferSubData, Bytes(size));
+    glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
+void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    // Unless told otherwise the driver waits for the GPU to finish with the range (or renames it)
+    Count(kMapBufferRange,
+          (access & GL_MAP_WRITE_BIT) ? Bytes(length) : 0,
+          (access & GL_MAP_UNSYNCHRONIZED_BIT) == 0);
+    return glMapBufferRange(target, offset, length, access);
+}
+
+GLboolean UnmapBuffer(GLenum target) {
+    // Returns whether the contents survived, which a threaded driver must wait to know
+    Count(kUnmapBuffer, 0, true);
+    return glUnmapBuffer(target);
+}
+
+void GetIntegerv(GLenum pname, GLint* data) {
+    Count(kGetIntegerv);
+    glGetIntegerv(pname, data);
+}
+
+void GetQueryObjectiv(GLuint id, GLenum pname, GLint* params) {
+    Count(kGetQueryObjectiv);
+    glGetQueryObjectiv(id, pname, params);
+}
+
+void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+    Count(kGetQueryObjectui64v);
+    glGetQueryObjectui64v(id, pname, params);
+}
+
+const GLubyte* GetString(GLenum name) {
+    Count(kGetString);
+    return glGetString(name);
+}
+
+GLint GetUniformLocation(GLuint program, const GLchar* name) {
+    Count(kGetUniformLocation);
+    return glGetUniformLocation(program, name);
+}
+
+GLboolean IsEnabled(GLenum cap) {
+    Count(kIsEnabled);
+    return glIsEnabled(cap);
+}
+
+void AttachShader(GLuint program, GLuint shader) {
+    Count(kAttachShader);
+    glAttachShader(program, shader);
+}
+
+void CompileShader(GLuint shader) {
+    Count(kCompileShader);
+    glCompileShader(shader);
+}
+
+GLuint CreateProgram() {
+    Count(kCreateProgram);
+    return glCreateProgram();
+}
+
+GLuint CreateShader(GLenum type) {
+    Count(kCreateShader);
+    return glCreateShader(type);
+}
+
+void DeleteBuffers(GLsizei n, const GLuint* buffers) {
+    Count(kDeleteBuffers);
+    glDeleteBuffers(n, buffers);
+}
+
+void DeleteQueries(GLsizei n, const GLuint* ids) {
+    Count(kDeleteQueries);
+    glDeleteQueries(n, ids);
+}
+
+void GenBuffers(GLsizei n, GLuint* buffers) {
+    Count(kGenBuffers);
+    glGenBuffers(n, buffers);
+}
+
+void GenQueries(GLsizei n, GLuint* ids) {
+    Count(kGenQueries);
+    glGenQueries(n, ids);
+}
+
+void GenVertexArrays(GLsizei n, GLuint* arrays) {
+    Count(kGenVertexArrays);
+    glGenVertexArrays(n, arrays);
+}
+
+void LinkProgram(GLuint program) {
+    Count(kLinkProgram);
+    glLinkProgram(program);
+}
+
+void ShaderSource(GLuint shader,
+                  GLsizei count,
+                  const GLchar* const* string,
+                  const GLint* length) {
+    Count(kShaderSource);
+    glShaderSource(shader, count, string, length);
+}
+
+}  // namespace glstats::hooks
+
+#endif
@@ -0,0 +1,65 @@
+#include "gpu_timer.h"
+
+#include <GL/glew.h>
+
+#include "gl_hooks.h"
+
+void GpuTimer::Initialize() {
+    glGenQueries(kLatency, queries);
+    initialized = true;
+}
+
+void GpuTimer::Shutdown() {
+    if (!initialized)
+        return;
+    glDeleteQueries(kLatency, queries);
+    initialized = false;
+}
+
+void GpuTimer::Begin(std::size_t frame) {
+    if (!initialized)
+        return;
+    // The slot is reused kLatency frames later; by then its result is almost always ready
+    if (pending[next])
+        Collect(next, true);
+    if (results.size() <= frame)
+        results.resize(frame + 1, -1.0);
+    frames[next] = frame;
+    glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+}
+
+void GpuTimer::End() {
+    if (!initialized)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[next] = true;
+    next = (next + 1) % kLatency;
+}
+
+void GpuTimer::Poll() {
+    for (int i = 0; i < kLatency; ++i) {
+        if (pending[i])
+            Collect(i, false);
+    }
+}
+
+void GpuTimer::Finish() {
+    for (int i = 0; i < kLatency; ++i) {
+        if (pending[i])
+            Collect(i, true);
+    }
+}
+
+bool GpuTimer::Collect(int slot, bool wait) {
+    if (!wait) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+    results[frames[slot]] = static_cast<double>(nanoseconds) / 1.0e6;
+    pending[slot] = false;
+    return true;
+}
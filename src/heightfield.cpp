@@ -0,0 +1,247 @@
+#include "heightfield.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEIGHTFIELD_SSE2 1
+#endif
+
+namespace {
+
+float SimpleNoise(float x, float y) {
+    int xi = (int)x & 255;
+    int yi = (int)y & 255;
+    float xf = x - (int)x;
+    float yf = y - (int)y;
+
+    // Simple hash function
+    int a = (xi + yi * 57) * 131;
+    int b = ((xi + 1) + yi * 57) * 131;
+    int c = (xi + (yi + 1) * 57) * 131;
+    int d = ((xi + 1) + (yi + 1) * 57) * 131;
+
+    float u = xf * xf * (3.0f - 2.0f * xf);
+    float v = yf * yf * (3.0f - 2.0f * yf);
+
+    float n1 = (float)(a & 255) / 255.0f;
+    float n2 = (float)(b & 255) / 255.0f;
+    float n3 = (float)(c & 255) / 255.0f;
+    float n4 = (float)(d & 255) / 255.0f;
+
+    float i1 = n1 * (1.0f - u) + n2 * u;
+    float i2 = n3 * (1.0f - u) + n4 * u;
+
+    return i1 * (1.0f - v) + i2 * v;
+}
+
+// Grid cell and fractional offsets for a world position, clamped to the grid
+struct CellSample {
+    std::size_t index;  // sample (x, z) at the cell's low corner
+    float fx, fz;
+};
+
+// Clamp a grid coordinate to [0, maxCoord]; NaN maps to 0 like the SSE2 path's max/min
+float ClampCoord(float g, float maxCoord) {
+    return std::isnan(g) ? 0.0f : std::clamp(g, 0.0f, maxCoord);
+}
+
+CellSample Locate(float x, float z, float originX, float originZ, float invCell, int size) {
+    const float maxCoord = static_cast<float>(size - 1);
+    const float maxCell = static_cast<float>(size - 2);
+    const float gx = ClampCoord((x - originX) * invCell, maxCoord);
+    const float gz = ClampCoord((z - originZ) * invCell, maxCoord);
+    const float cx = std::min(std::floor(gx), maxCell);
+    const float cz = std::min(std::floor(gz), maxCell);
+    return {static_cast<std::size_t>(cz) * size + static_cast<std::size_t>(cx), gx - cx, gz - cz};
+}
+
+#ifdef HEIGHTFIELD_SSE2
+// Four-lane version of Locate plus the cell corner heights
+struct CellSample4 {
+    __m128 h00, h10, h01, h11;
+    __m128 fx, fz;
+};
+
+class Locator4 {
+  public:
+    Locator4(const float* data, int size, float originX, float originZ, float invCell)
+        : data(data),
+          size(size),
+          originX(_mm_set1_ps(originX)),
+          originZ(_mm_set1_ps(originZ)),
+          invCell(_mm_set1_ps(invCell)),
+          maxCoord(_mm_set1_ps(static_cast<float>(size - 1))),
+          maxCell(_mm_set1_ps(static_cast<float>(size - 2))),
+          stride(_mm_set1_ps(static_cast<float>(size))) {}
+
+    CellSample4 Locate(const float* xs, const float* zs) const {
+        const __m128 zero = _mm_setzero_ps();
+        __m128 gx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(xs), originX), invCell);
+        __m128 gz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(zs), originZ), invCell);
+        // maxps returns its second operand for NaN, so NaN lanes land on 0
+        gx = _mm_min_ps(_mm_max_ps(gx, zero), maxCoord);
+        gz = _mm_min_ps(_mm_max_ps(gz, zero), maxCoord);
+        // Coordinates are non-negative, so truncation is floor
+        const __m128 cx = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gx)), maxCell);
+        const __m128 cz = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gz)), maxCell);
+        alignas(16) int idx[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx),
+                        _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(cz, stride), cx)));
+
+        // SSE2 has no gather; fetch the four corners per lane with scalar loads
+        alignas(16) float corners[4][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const float* row0 = data + idx[lane];
+            corners[0][lane] = row0[0];
+            corners[1][lane] = row0[1];
+            corners[2][lane] = row0[size];
+            corners[3][lane] = row0[size + 1];
+        }
+        return {_mm_load_ps(corners[0]),
+                _mm_load_ps(corners[1]),
+                _mm_load_ps(corners[2]),
+                _mm_load_ps(corners[3]),
+                _mm_sub_ps(gx, cx),
+                _mm_sub_ps(gz, cz)};
+    }
+
+  private:
+    const float* data;
+    int size;
+    __m128 originX, originZ, invCell, maxCoord, maxCell, stride;
+};
+#endif
+
+}  // namespace
+
+void Heightfield::Generate(int vertsPerSide, float cell) {
+    size = vertsPerSide;
+    cellSize = cell;
+    const float half = (vertsPerSide - 1) * cellSize * 0.5f;
+    originX = -half;
+    originZ = -half;
+    heights.resize(static_cast<std::size_t>(size) * size);
+
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            float n = 0.0f;
+            // FBM-like layered noise for nicer terrain
+            float fx = x * 0.08f;
+            float fz = z * 0.08f;
+            float amp = 1.0f;
+            float freq = 1.0f;
+            for (int o = 0; o < 4; ++o) {
+                n += SimpleNoise(fx * freq, fz * freq) * amp;
+                freq *= 2.0f;
+                amp *= 0.5f;
+            }
+            n = (n / (1.0f + 0.5f + 0.25f + 0.125f));  // normalize approx 0..1
+            heights[static_cast<std::size_t>(z) * size + x] = (n - 0.5f) * 4.0f;  // -2..2
+        }
+    }
+
+    const auto [lo, hi] = std::minmax_element(heights.begin(), heights.end());
+    minHeight = *lo;
+    maxHeight = *hi;
+}
+
+bool Heightfield::Contains(float x, float z) const {
+    const float extent = (size - 1) * cellSize;
+    return size > 1 && x >= originX && z >= originZ && x <= originX + extent &&
+           z <= originZ + extent;
+}
+
+float Heightfield::SampleHeight(float x, float z) const {
+    if (size < 2)
+        return 0.0f;
+    const CellSample c = Locate(x, z, originX, originZ, 1.0f / cellSize, size);
+    const float* row0 = heights.data() + c.index;
+    const float* row1 = row0 + size;
+    const float h0 = row0[0] + (row0[1] - row0[0]) * c.fx;
+    const float h1 = row1[0] + (row1[1] - row1[0]) * c.fx;
+    return h0 + (h1 - h0) * c.fz;
+}
+
+void Heightfield::SampleNormal(float x, float z, float& nx, float& ny, float& nz) const {
+    nx = 0.0f;
+    ny = 1.0f;
+    nz = 0.0f;
+    if (size < 2)
+        return;
+    const float invCell = 1.0f / cellSize;
+    const CellSample c = Locate(x, z, originX, originZ, invCell, size);
+    const float* row0 = heights.data() + c.index;
+    const float* row1 = row0 + size;
+    // Partial derivatives of the bilinear patch; normal is (-dh/dx, 1, -dh/dz) normalized
+    const float dx = ((row0[1] - row0[0]) * (1.0f - c.fz) + (row1[1] - row1[0]) * c.fz) * invCell;
+    const float dz = ((row1[0] - row0[0]) * (1.0f - c.fx) + (row1[1] - row0[1]) * c.fx) * invCell;
+    const float invLen = 1.0f / std::sqrt(dx * dx + 1.0f + dz * dz);
+    nx = -dx * invLen;
+    ny = invLen;
+    nz = -dz * invLen;
+}
+
+void Heightfield::SampleHeights(const float* xs,
+                                const float* zs,
+                                float* outHeights,
+                                std::size_t count) const {
+    std::size_t i = 0;
+    if (size < 2) {
+        for (; i < count; ++i) {
+            outHeights[i] = 0.0f;
+        }
+        return;
+    }
+#ifdef HEIGHTFIELD_SSE2
+    const Locator4 locator(heights.data(), size, originX, originZ, 1.0f / cellSize);
+    for (; i + 4 <= count; i += 4) {
+        const CellSample4 c = locator.Locate(xs + i, zs + i);
+        const __m128 h0 = _mm_add_ps(c.h00, _mm_mul_ps(_mm_sub_ps(c.h10, c.h00), c.fx));
+        const __m128 h1 = _mm_add_ps(c.h01, _mm_mul_ps(_mm_sub_ps(c.h11, c.h01), c.fx));
+        _mm_storeu_ps(outHeights + i, _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), c.fz)));
+    }
+#endif
+    for (; i < count; ++i) {
+        outHeights[i] = SampleHeight(xs[i], zs[i]);
+    }
+}
+
+void Heightfield::SampleNormals(const float* xs,
+                                const float* zs,
+                                float* outX,
+                                float* outY,
+                                float* outZ,
+                                std::size_t count) const {
+    std::size_t i = 0;
+#ifdef HEIGHTFIELD_SSE2
+    if (size >= 2) {
+        const float invCell = 1.0f / cellSize;
+        const Locator4 locator(heights.data(), size, originX, originZ, invCell);
+        const __m128 inv = _mm_set1_ps(invCell);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const CellSample4 c = locator.Locate(xs + i, zs + i);
+            const __m128 dx = _mm_mul_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_sub_ps(c.h10, c.h00), _mm_sub_ps(one, c.fz)),
+                           _mm_mul_ps(_mm_sub_ps(c.h11, c.h01), c.fz)),
+                inv);
+            const __m128 dz = _mm_mul_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_sub_ps(c.h01, c.h00), _mm_sub_ps(one, c.fx)),
+                           _mm_mul_ps(_mm_sub_ps(c.h11, c.h10), c.fx)),
+                inv);
+            const __m128 invLen = _mm_div_ps(
+                one,
+                _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), one), _mm_mul_ps(dz, dz))));
+            _mm_storeu_ps(outX + i, _mm_mul_ps(_mm_sub_ps(zero, dx), invLen));
+            _mm_storeu_ps(outY + i, invLen);
+            _mm_storeu_ps(outZ + i, _mm_mul_ps(_mm_sub_ps(zero, dz), invLen));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        SampleNormal(xs[i], zs[i], outX[i], outY[i], outZ[i]);
+    }
+}
@@ -0,0 +1,228 @@
+#include "jobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "logger.h"
+
+namespace jobs::detail {
+
+struct TaskState {
+    std::function<void()> fn;
+    bool started = false;  // guarded by poolMutex
+    std::atomic<bool> done{false};
+};
+
+}  // namespace jobs::detail
+
+namespace {
+
+using jobs::detail::TaskState;
+
+// A ParallelFor call in flight. Lives on the caller's stack; workers only join it while it is
+// linked into the active list, and the caller waits for them to leave before returning.
+struct ParallelJob {
+    jobs::detail::RangeFn fn = nullptr;
+    void* context = nullptr;
+    std::size_t count = 0;
+    std::size_t grain = 1;
+    std::size_t chunkCount = 0;
+    std::atomic<std::size_t> nextChunk{0};
+    // Chunks run on workers are checked against the caller's no-allocation scope
+    alloc::NoAllocScope* noAllocScope = nullptr;
+    int activeWorkers = 0;  // guarded by poolMutex
+    ParallelJob* next = nullptr;
+};
+
+std::vector<std::thread> workers;
+std::mutex poolMutex;
+std::condition_variable workAvailable;
+std::condition_variable workerLeft;
+ParallelJob* activeJobs = nullptr;
+std::deque<std::shared_ptr<TaskState>> tasks;
+std::condition_variable taskFinished;
+bool stopping = false;
+
+void RunChunks(ParallelJob& job) {
+    for (;;) {
+        const std::size_t chunk = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= job.chunkCount)
+            return;
+        const std::size_t begin = chunk * job.grain;
+        const std::size_t end = std::min(begin + job.grain, job.count);
+        job.fn(job.context, begin, end);
+    }
+}
+
+ParallelJob* FindJobWithWork() {
+    for (ParallelJob* job = activeJobs; job; job = job->next) {
+        if (job->nextChunk.load(std::memory_order_relaxed) < job->chunkCount)
+            return job;
+    }
+    return nullptr;
+}
+
+// Runs a task claimed under poolMutex (started set); called and returns with the lock held
+void RunTask(std::unique_lock<std::mutex>& lock, TaskState& task) {
+    lock.unlock();
+    task.fn();
+    task.fn = nullptr;
+    lock.lock();
+    task.done.store(true, std::memory_order_release);
+    taskFinished.notify_all();
+}
+
+void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(poolMutex);
+    for (;;) {
+        ParallelJob* job = nullptr;
+        workAvailable.wait(lock, [&] {
+            return stopping || (job = FindJobWithWork()) != nullptr || !tasks.empty();
+        });
+        if (stopping)
+            return;
+        if (!job) {
+            const std::shared_ptr<TaskState> task = std::move(tasks.front());
+            tasks.pop_front();
+            task->started = true;
+            RunTask(lock, *task);
+            continue;
+        }
+        ++job->activeWorkers;
+        lock.unlock();
+        {
+            alloc::InheritNoAllocScope noAlloc(job->noAllocScope);
+            RunChunks(*job);
+        }
+        lock.lock();
+        if (--job->activeWorkers == 0)
+            workerLeft.notify_all();
+    }
+}
+
+}  // namespace
+
+namespace jobs {
+
+void Initialize(unsigned int workerCount) {
+    if (!workers.empty())
+        return;
+    if (workerCount == 0) {
+        const unsigned int hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 0;
+    }
+    stopping = false;
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(WorkerLoop);
+    }
+    LOG_INFO("Job system started with %u worker threads", workerCount);
+}
+
+void Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    // Tasks nobody picked up still run, so waiting on them cannot hang
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (!tasks.empty()) {
+        const std::shared_ptr<TaskState> task = std::move(tasks.front());
+        tasks.pop_front();
+        task->started = true;
+        RunTask(lock, *task);
+    }
+}
+
+unsigned int WorkerCount() {
+    return static_cast<unsigned int>(workers.size());
+}
+
+namespace detail {
+
+void ParallelFor(std::size_t count, std::size_t grain, RangeFn fn, void* context) {
+    if (count == 0)
+        return;
+    grain = std::max<std::size_t>(grain, 1);
+    if (workers.empty() || count <= grain) {
+        fn(context, 0, count);
+        return;
+    }
+
+    ParallelJob job;
+    job.fn = fn;
+    job.context = context;
+    job.count = count;
+    job.grain = grain;
+    job.chunkCount = (count + grain - 1) / grain;
+    job.noAllocScope = alloc::CurrentNoAllocScope();
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        job.next = activeJobs;
+        activeJobs = &job;
+    }
+    workAvailable.notify_all();
+
+    RunChunks(job);
+
+    // Unlink so no new worker picks the job up, then wait for the ones still running chunks
+    std::unique_lock<std::mutex> lock(poolMutex);
+    for (ParallelJob** link = &activeJobs; *link; link = &(*link)->next) {
+        if (*link == &job) {
+            *link = job.next;
+            break;
+        }
+    }
+    workerLeft.wait(lock, [&] { return job.activeWorkers == 0; });
+}
+
+}  // namespace detail
+
+bool Task::Done() const {
+    return !state || state->done.load(std::memory_order_acquire);
+}
+
+void Task::Wait() const {
+    if (Done())
+        return;
+    std::unique_lock<std::mutex> lock(poolMutex);
+    if (!state->started) {
+        tasks.erase(std::find(tasks.begin(), tasks.end(), state));
+        state->started = true;
+        RunTask(lock, *state);
+        return;
+    }
+    taskFinished.wait(lock, [&] { return state->done.load(std::memory_order_relaxed); });
+}
+
+Task Async(std::function<void()> fn) {
+    Task task;
+    task.state = std::make_shared<TaskState>();
+    task.state->fn = std::move(fn);
+    if (workers.empty()) {
+        task.state->started = true;
+        task.state->fn();
+        task.state->fn = nullptr;
+        task.state->done.store(true, std::memory_order_release);
+        return task;
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        tasks.push_back(task.state);
+    }
+    workAvailable.notify_one();
+    return task;
+}
+
+}  // namespace jobs
@@ -1,9 +1,9 @@
 #include "logger.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdarg>
 #include <ctime>
-#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -11,16 +11,38 @@
 #include <mutex>
 #include <sstream>
 
+#include "alloc_tracker.h"
+#include "frame_arena.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
 namespace {
 
-std::deque<std::string> recentLogs;
+// Ring of recent lines, reserved on first use. New lines are built in place and reuse the slot's
+// capacity, so logging does not allocate unless a line outgrows its slot.
+std::vector<std::string> recentLogs;
+std::size_t recentCount = 0;
+std::size_t recentStart = 0;  // index of the oldest line once the ring is full
 std::mutex logMutex;
 std::ofstream logFile;
 constexpr std::size_t kMaxRecentLogs = 1000;
+constexpr std::size_t kRecentLineReserve = 128;
+
+std::string& NextRecentSlot() {
+    if (recentLogs.empty()) {
+        recentLogs.resize(kMaxRecentLogs);
+        for (std::string& line : recentLogs) {
+            line.reserve(kRecentLineReserve);
+        }
+    }
+    if (recentCount < kMaxRecentLogs)
+        return recentLogs[recentCount++];
+    std::string& slot = recentLogs[recentStart];
+    recentStart = (recentStart + 1) % kMaxRecentLogs;
+    return slot;
+}
 
 }  // namespace
 
@@ -60,9 +82,11 @@ void Shutdown() {
     }
 }
 
-std::string format(const char* fmt, ...) {
+std::pmr::string format(const char* fmt, ...) {
+    std::pmr::string buf(frame::Resource());
     if (!fmt)
-        return {};
+        return buf;
+    alloc::Scope allocScope("Logging");
     va_list args;
     va_start(args, fmt);
     va_list args_copy;
@@ -71,17 +95,16 @@ std::string format(const char* fmt, ...) {
     va_end(args_copy);
     if (len <= 0) {
         va_end(args);
-        return {};
+        return buf;
     }
-    std::string buf;
     buf.resize(static_cast<size_t>(len));
     vsnprintf(buf.data(), static_cast<size_t>(len) + 1, fmt, args);
     va_end(args);
     return buf;
 }
 
-void LogMessage(const std::string& level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(logMutex);
+void LogMessage(std::string_view level, std::string_view message) {
+    alloc::Scope allocScope("Logging");
 
     const auto now = std::chrono::system_clock::now();
     const auto timeT = std::chrono::system_clock::to_time_t(now);
@@ -91,11 +114,15 @@ void LogMessage(const std::string& level, const std::string& message) {
 #else
     localtime_r(&timeT, &tm);
 #endif
+    char timeText[16];
+    std::strftime(timeText, sizeof(timeText), "%H:%M:%S", &tm);
 
-    std::ostringstream oss;
-    oss << "[" << std::put_time(&tm, "%H:%M:%S") << "] [" << level << "] " << message;
+    std::lock_guard<std::mutex> lock(logMutex);
 
-    const std::string logEntry = oss.str();
+    // Build the entry directly in its ring slot; this is also the copy kept for ImGui
+    std::string& logEntry = NextRecentSlot();
+    logEntry.clear();
+    logEntry.append("[").append(timeText).append("] [").append(level).append("] ").append(message);
 
     // Console output
     std::cout << logEntry << std::endl;
@@ -106,21 +133,18 @@ void LogMessage(const std::string& level, const std::string& message) {
         logFile.flush();
     }
 
-    // Store for ImGui
-    recentLogs.push_back(logEntry);
-    if (recentLogs.size() > kMaxRecentLogs) {
-        recentLogs.pop_front();
-    }
-
     // Optional: platform-specific debug output could be added here
 }
 
-std::vector<std::string> GetRecentLogs(std::size_t maxLines) {
+std::pmr::vector<std::pmr::string> GetRecentLogs(std::size_t maxLines,
+                                                 std::pmr::memory_resource* resource) {
+    alloc::Scope allocScope("Logging");
     std::lock_guard<std::mutex> lock(logMutex);
-    std::vector<std::string> result;
-    const std::size_t start = recentLogs.size() > maxLines ? recentLogs.size() - maxLines : 0;
-    for (std::size_t i = start; i < recentLogs.size(); ++i) {
-        result.push_back(recentLogs[i]);
+    std::pmr::vector<std::pmr::string> result(resource);
+    const std::size_t count = std::min(maxLines, recentCount);
+    result.reserve(count);
+    for (std::size_t i = recentCount - count; i < recentCount; ++i) {
+        result.emplace_back(recentLogs[(recentStart + i) % kMaxRecentLogs]);
     }
     return result;
 }
@@ -1,7 +1,37 @@
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "frame_pacer.h"
+#include "jobs.h"
 #include "logger.h"
+#include "replay.h"
+#include "startup.h"
 #include "window.h"
 
-int main() {
+namespace {
+
+// Value following `flag` on the command line, or empty
+std::string ArgValue(int argc, char** argv, const char* flag) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == flag)
+            return argv[i + 1];
+    }
+    return {};
+}
+
+bool HasArg(int argc, char** argv, const char* flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == flag)
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    startup::Begin();
     logging::Initialize();
     LOG_INFO("Application start");
 #ifdef USE_IMGUI
@@ -9,15 +39,62 @@ int main() {
 #else
     LOG_WARN("[main.cpp] USE_IMGUI is NOT defined");
 #endif
+    jobs::Initialize();
+
+    // Headless benchmarks: OpenGLTerrain --bench <name>
+    if (argc >= 3 && std::string(argv[1]) == "--bench") {
+        const int result = bench::Run(argv[2]);
+        jobs::Shutdown();
+        logging::Shutdown();
+        return result;
+    }
+
+    // Input replay: OpenGLTerrain --replay <file> [--timings <csv>] [--headless]
+    const std::string replayPath = ArgValue(argc, argv, "--replay");
+    std::string timingsPath = ArgValue(argc, argv, "--timings");
+    if (!replayPath.empty() && timingsPath.empty())
+        timingsPath = replayPath + ".csv";
+    if (!replayPath.empty() && HasArg(argc, argv, "--headless")) {
+        const int result = replay::RunHeadless(replayPath, timingsPath);
+        jobs::Shutdown();
+        logging::Shutdown();
+        return result;
+    }
 
     Window window;
+    if (!replayPath.empty() && !window.ReplayFrom(replayPath, timingsPath)) {
+        jobs::Shutdown();
+        return -1;
+    }
+    // Presentation: --present vsync|adaptive|uncapped|limited, --fps <n>, --low-latency
+    PresentOptions present;
+    const std::string fps = ArgValue(argc, argv, "--fps");
+    if (!fps.empty()) {
+        present.mode = PresentMode::kLimited;
+        present.targetFps = std::strtof(fps.c_str(), nullptr);
+    }
+    const std::string presentMode = ArgValue(argc, argv, "--present");
+    if (!presentMode.empty() && !ParsePresentMode(presentMode, present.mode))
+        LOG_WARN("Unknown present mode '%s'; using %s",
+                 presentMode.c_str(),
+                 PresentModeName(present.mode));
+    present.lowLatency = HasArg(argc, argv, "--low-latency");
+    window.SetPresentOptions(present);
+
+    // Input recording: OpenGLTerrain --record <file>
+    const std::string recordPath = ArgValue(argc, argv, "--record");
+    if (!recordPath.empty())
+        window.RecordTo(recordPath);
+
     if (!window.Create()) {
         LOG_ERROR("Window creation failed");
+        jobs::Shutdown();
         return -1;
     }
 
     window.Run();
     LOG_INFO("Application exit");
+    jobs::Shutdown();
     logging::Shutdown();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "occlusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "jobs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE2 1
+#endif
+
+namespace {
+
+constexpr int kBlocksX = OcclusionCuller::kWidth / OcclusionCuller::kBlockSize;
+constexpr int kBlocksY = OcclusionCuller::kHeight / OcclusionCuller::kBlockSize;
+// Boxes within this depth of an occluder count as visible, absorbing rasterization error
+constexpr float kDepthBias = 1e-5f;
+
+void Transform(const float m[16], float x, float y, float z, float out[4]) {
+    out[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+    out[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+    out[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+    out[3] = m[3] * x + m[7] * y + m[11] * z + m[15];
+}
+
+// Edge function E(px, py) = a * px + b * py + c, non-negative inside a CCW triangle
+struct Edge {
+    float a, b, c;
+    Edge(float ax, float ay, float bx, float by)
+        : a(ay - by), b(bx - ax), c((by - ay) * ax - (bx - ax) * ay) {}
+};
+
+}  // namespace
+
+void OcclusionCuller::BeginFrame(const float matrix[16], float near) {
+    std::copy(matrix, matrix + 16, viewProj);
+    nearW = near;
+    depth.assign(static_cast<std::size_t>(kWidth) * kHeight, 1.0f);
+    blockMax.assign(static_cast<std::size_t>(kBlocksX) * kBlocksY, 1.0f);
+}
+
+void OcclusionCuller::RasterizeOccluders(const float* positions,
+                                         std::size_t vertexCount,
+                                         const std::uint32_t* indices,
+                                         std::size_t triangleCount) {
+    if (screenVertices.size() < vertexCount)
+        screenVertices.resize(vertexCount);
+
+    jobs::ParallelFor(vertexCount, 1024, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const float* p = positions + i * 3;
+            float clip[4];
+            Transform(viewProj, p[0], p[1], p[2], clip);
+            ScreenVertex& v = screenVertices[i];
+            if (clip[3] < nearW) {
+                v = {0.0f, 0.0f, -1.0f};
+                continue;
+            }
+            const float invW = 1.0f / clip[3];
+            v.x = (clip[0] * invW * 0.5f + 0.5f) * kWidth;
+            v.y = (clip[1] * invW * 0.5f + 0.5f) * kHeight;
+            v.z = clip[2] * invW * 0.5f + 0.5f;
+        }
+    });
+
+    // One strip per block row, so each strip can also build its own block maxima
+    jobs::ParallelFor(kBlocksY, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t strip = begin; strip < end; ++strip) {
+            const int rowBegin = static_cast<int>(strip) * kBlockSize;
+            RasterizeStrip(rowBegin, rowBegin + kBlockSize, indices, triangleCount);
+            BuildBlocks(rowBegin, rowBegin + kBlockSize);
+        }
+    });
+}
+
+void OcclusionCuller::RasterizeStrip(int rowBegin,
+                                     int rowEnd,
+                                     const std::uint32_t* indices,
+                                     std::size_t triangleCount) {
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        ScreenVertex v0 = screenVertices[indices[t * 3]];
+        ScreenVertex v1 = screenVertices[indices[t * 3 + 1]];
+        ScreenVertex v2 = screenVertices[indices[t * 3 + 2]];
+        // Triangles crossing the near plane are skipped; dropping an occluder is conservative
+        if (v0.z < 0.0f || v1.z < 0.0f || v2.z < 0.0f)
+            continue;
+
+        const int minY =
+            std::max(rowBegin, static_cast<int>(std::floor(std::min({v0.y, v1.y, v2.y}))));
+        const int maxY =
+            std::min(rowEnd - 1, static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}))));
+        if (minY > maxY)
+            continue;
+        const int minX = std::max(0, static_cast<int>(std::floor(std::min({v0.x, v1.x, v2.x}))));
+        const int maxX =
+            std::min(kWidth - 1, static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}))));
+        if (minX > maxX)
+            continue;
+
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if (std::fabs(area) < 1e-8f)
+            continue;
+        if (area < 0.0f) {
+            std::swap(v1, v2);
+            area = -area;
+        }
+        const Edge e0(v1.x, v1.y, v2.x, v2.y);  // weight of v0
+        const Edge e1(v2.x, v2.y, v0.x, v0.y);  // weight of v1
+        const Edge e2(v0.x, v0.y, v1.x, v1.y);  // weight of v2
+        const float invArea = 1.0f / area;
+        const float za = (e0.a * v0.z + e1.a * v1.z + e2.a * v2.z) * invArea;
+        const float zb = (e0.b * v0.z + e1.b * v1.z + e2.b * v2.z) * invArea;
+        const float zc = (e0.c * v0.z + e1.c * v1.z + e2.c * v2.z) * invArea;
+
+        // Rows are processed four pixels at a time starting from an aligned column
+        const int startX = minX & ~3;
+        for (int y = minY; y <= maxY; ++y) {
+            const float py = y + 0.5f;
+            float* row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+#ifdef OCCLUSION_SSE2
+            const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 a0 = _mm_set1_ps(e0.a), a1 = _mm_set1_ps(e1.a), a2 = _mm_set1_ps(e2.a);
+            const __m128 r0 = _mm_set1_ps(e0.b * py + e0.c);
+            const __m128 r1 = _mm_set1_ps(e1.b * py + e1.c);
+            const __m128 r2 = _mm_set1_ps(e2.b * py + e2.c);
+            const __m128 zA = _mm_set1_ps(za);
+            const __m128 zRow = _mm_set1_ps(zb * py + zc);
+            for (int x = startX; x <= maxX; x += 4) {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                const __m128 w0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                const __m128 w1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                const __m128 w2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+                const __m128 inside = _mm_and_ps(
+                    _mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                    _mm_cmpge_ps(w2, zero));
+                const __m128 current = _mm_loadu_ps(row + x);
+                const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(zA, px), zRow), current);
+                _mm_storeu_ps(row + x,
+                              _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int x = startX; x <= maxX; ++x) {
+                const float px = x + 0.5f;
+                if (e0.a * px + e0.b * py + e0.c >= 0.0f && e1.a * px + e1.b * py + e1.c >= 0.0f &&
+                    e2.a * px + e2.b * py + e2.c >= 0.0f)
+                    row[x] = std::min(row[x], za * px + zb * py + zc);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::BuildBlocks(int rowBegin, int rowEnd) {
+    for (int by = rowBegin / kBlockSize; by < rowEnd / kBlockSize; ++by) {
+        for (int bx = 0; bx < kBlocksX; ++bx) {
+            float m = 0.0f;
+            for (int y = by * kBlockSize; y < (by + 1) * kBlockSize; ++y) {
+                const float* row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+                for (int x = bx * kBlockSize; x < (bx + 1) * kBlockSize; ++x) {
+                    m = std::max(m, row[x]);
+                }
+            }
+            blockMax[static_cast<std::size_t>(by) * kBlocksX + bx] = m;
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const Bounds& box) const {
+    float clip[8][4];
+    for (int i = 0; i < 8; ++i) {
+        Transform(viewProj,
+                  (i & 1) ? box.maxX : box.minX,
+                  (i & 2) ? box.maxY : box.minY,
+                  (i & 4) ? box.maxZ : box.minZ,
+                  clip[i]);
+    }
+    // Frustum: reject when every corner is outside the same clip plane
+    for (int axis = 0; axis < 3; ++axis) {
+        bool allBelow = true, allAbove = true;
+        for (const float* c : clip) {
+            allBelow = allBelow && c[axis] < -c[3];
+            allAbove = allAbove && c[axis] > c[3];
+        }
+        if (allBelow || allAbove)
+            return false;
+    }
+
+    float minSx = static_cast<float>(kWidth), minSy = static_cast<float>(kHeight);
+    float maxSx = 0.0f, maxSy = 0.0f;
+    float nearest = 1.0f;
+    for (const float* c : clip) {
+        // Boxes reaching behind the near plane cannot be projected and are never occluded
+        if (c[3] < nearW)
+            return true;
+        const float invW = 1.0f / c[3];
+        const float sx = (c[0] * invW * 0.5f + 0.5f) * kWidth;
+        const float sy = (c[1] * invW * 0.5f + 0.5f) * kHeight;
+        const float z = c[2] * invW * 0.5f + 0.5f;
+        minSx = std::min(minSx, sx);
+        maxSx = std::max(maxSx, sx);
+        minSy = std::min(minSy, sy);
+        maxSy = std::max(maxSy, sy);
+        nearest = std::min(nearest, z);
+    }
+
+    const int x0 = std::max(0, static_cast<int>(minSx));
+    const int y0 = std::max(0, static_cast<int>(minSy));
+    const int x1 = std::min(kWidth - 1, static_cast<int>(maxSx));
+    const int y1 = std::min(kHeight - 1, static_cast<int>(maxSy));
+    const float threshold = nearest - kDepthBias;
+
+    for (int by = y0 / kBlockSize; by <= y1 / kBlockSize; ++by) {
+        for (int bx = x0 / kBlockSize; bx <= x1 / kBlockSize; ++bx) {
+            // Cheap reject on the block level, exact check on the covered pixels otherwise
+            if (blockMax[static_cast<std::size_t>(by) * kBlocksX + bx] < threshold)
+                continue;
+            const int px0 = std::max(x0, bx * kBlockSize);
+            const int px1 = std::min(x1, (bx + 1) * kBlockSize - 1);
+            const int py0 = std::max(y0, by * kBlockSize);
+            const int py1 = std::min(y1, (by + 1) * kBlockSize - 1);
+            for (int y = py0; y <= py1; ++y) {
+                const float* row = depth.data() + static_cast<std::size_t>(y) * kWidth;
+                for (int x = px0; x <= px1; ++x) {
+                    if (row[x] >= threshold)
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void OcclusionCuller::TestVisibility(const Bounds* boxes,
+                                     std::uint8_t* visible,
+                                     std::size_t count) const {
+    jobs::ParallelFor(count, 32, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            visible[i] = IsVisible(boxes[i]) ? 1 : 0;
+        }
+    });
+}
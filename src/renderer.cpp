@@ -2,6 +2,7 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdio>
@@ -11,13 +12,18 @@
 #include <sstream>
 #include <string>
 
+#include "alloc_tracker.h"
+#include "frame_arena.h"
+#include "gl_hooks.h"
 #include "logger.h"
+#include "startup.h"
 
 #ifdef USE_IMGUI
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 #include "imgui.h"
 #endif
+
 bool Renderer::Initialize(GLFWwindow* win) {
     srand((unsigned int)time(nullptr));
     window = win;
@@ -29,15 +35,17 @@ bool Renderer::Initialize(GLFWwindow* win) {
     LOG_INFO("OpenGL Renderer: %s", gl_renderer ? gl_renderer : "<null>");
     LOG_INFO("OpenGL Vendor: %s", gl_vendor ? gl_vendor : "<null>");
 
-    shaderProgram = CreateShaderFromFiles("terrain.vert", "terrain.frag");
-    CreateGrid();
+    // Shader files and the terrain are prepared on workers; Render picks them up as they finish
+    // and streams the terrain to the GPU over the next frames, so the window is responsive and
+    // shows a placeholder from the first frame on
+    shaderTask = jobs::Async([this] { LoadShaderSources("terrain.vert", "terrain.frag"); });
+    terrainTask = jobs::Async([this] { BuildTerrain(); });
     CreateCube();
     CreateCrosshair();
+    uploader.Initialize(kUploadSliceBytes);
 
     glEnable(GL_DEPTH_TEST);
 
-    // VSync handled via glfwSwapInterval in window
-
     return true;
 }
 
@@ -67,18 +75,27 @@ std::string Renderer::ReadTextFile(const char* path) {
     return ss.str();
 }
 
-unsigned int Renderer::CreateShaderFromFiles(const char* vertexPath, const char* fragmentPath) {
+void Renderer::LoadShaderSources(const char* vertexPath, const char* fragmentPath) {
+    startup::Phase phase("shader files");
 #ifdef SHADER_DIR
-    std::string vpath = std::string(SHADER_DIR) + "/" + vertexPath;
-    std::string fpath = std::string(SHADER_DIR) + "/" + fragmentPath;
+    shaderFiles.vertexPath = std::string(SHADER_DIR) + "/" + vertexPath;
+    shaderFiles.fragmentPath = std::string(SHADER_DIR) + "/" + fragmentPath;
 #else
-    std::string vpath = vertexPath;
-    std::string fpath = fragmentPath;
+    shaderFiles.vertexPath = vertexPath;
+    shaderFiles.fragmentPath = fragmentPath;
 #endif
-    std::string vsrc = ReadTextFile(vpath.c_str());
-    std::string fsrc = ReadTextFile(fpath.c_str());
+    shaderFiles.vertexSource = ReadTextFile(shaderFiles.vertexPath.c_str());
+    shaderFiles.fragmentSource = ReadTextFile(shaderFiles.fragmentPath.c_str());
+}
+
+unsigned int Renderer::BuildShaderProgram() {
+    startup::Phase phase("shader build");
+    const std::string& vsrc = shaderFiles.vertexSource;
+    const std::string& fsrc = shaderFiles.fragmentSource;
     if (vsrc.empty() || fsrc.empty()) {
-        LOG_ERROR("Failed to load shaders: %s, %s", vpath.c_str(), fpath.c_str());
+        LOG_ERROR("Failed to load shaders: %s, %s",
+                  shaderFiles.vertexPath.c_str(),
+                  shaderFiles.fragmentPath.c_str());
         // Fallback minimal shaders
         const char* vs =
             "#version 330 core\nlayout(location=0) in vec3 aPos; layout(location=1) in vec3 "
@@ -93,111 +110,24 @@ unsigned int Renderer::CreateShaderFromFiles(const char* vertexPath, const char*
     return CreateShader(vsrc.c_str(), fsrc.c_str());
 }
 
-float Renderer::SimpleNoise(float x, float y) {
-    int xi = (int)x & 255;
-    int yi = (int)y & 255;
-    float xf = x - (int)x;
-    float yf = y - (int)y;
-
-    // Simple hash function
-    int a = (xi + yi * 57) * 131;
-    int b = ((xi + 1) + yi * 57) * 131;
-    int c = (xi + (yi + 1) * 57) * 131;
-    int d = ((xi + 1) + (yi + 1) * 57) * 131;
-
-    float u = xf * xf * (3.0f - 2.0f * xf);
-    float v = yf * yf * (3.0f - 2.0f * yf);
-
-    float n1 = (float)(a & 255) / 255.0f;
-    float n2 = (float)(b & 255) / 255.0f;
-    float n3 = (float)(c & 255) / 255.0f;
-    float n4 = (float)(d & 255) / 255.0f;
-
-    float i1 = n1 * (1.0f - u) + n2 * u;
-    float i2 = n3 * (1.0f - u) + n4 * u;
-
-    return i1 * (1.0f - v) + i2 * v;
-}
-
-void Renderer::CreateGrid() {
+void Renderer::BuildTerrain() {
+    alloc::Scope allocScope("Terrain");
     // Create a large noise-displaced grid (terrain) centered at origin on XZ plane
-    const int vertsPerSide = 256;  // 256x256 grid
-    const float cellSize = 0.2f;   // 256 * 0.2 = ~51.2 units per side
-    const float half = (vertsPerSide - 1) * cellSize * 0.5f;
-
-    // Each vertex: position (3) + color (3)
-    const int vertexStride = 6;
-    const int vertexCount = vertsPerSide * vertsPerSide;
-    const int quadCount = (vertsPerSide - 1) * (vertsPerSide - 1);
-    const int indexCount = quadCount * 6;
-
-    float* vertices = new float[vertexCount * vertexStride];
-    unsigned int* indices = new unsigned int[indexCount];
-
-    // Generate vertices with noise height on Y and color by height
-    int v = 0;
-    for (int z = 0; z < vertsPerSide; ++z) {
-        for (int x = 0; x < vertsPerSide; ++x) {
-            float worldX = -half + x * cellSize;
-            float worldZ = -half + z * cellSize;
-            float n = 0.0f;
-            // FBM-like layered noise for nicer terrain
-            float fx = x * 0.08f;
-            float fz = z * 0.08f;
-            float amp = 1.0f;
-            float freq = 1.0f;
-            for (int o = 0; o < 4; ++o) {
-                n += SimpleNoise(fx * freq, fz * freq) * amp;
-                freq *= 2.0f;
-                amp *= 0.5f;
-            }
-            n = (n / (1.0f + 0.5f + 0.25f + 0.125f));  // normalize approx 0..1
-            float height = (n - 0.5f) * 4.0f;          // scale to -2..2
-
-            // position
-            vertices[v++] = worldX;  // x
-            vertices[v++] = height;  // y
-            vertices[v++] = worldZ;  // z
-            // color based on height: low=blueish, mid=green, high=brownish
-            float r = 0, g = 0, b = 0;
-            if (height < -0.5f) {
-                r = 0.1f;
-                g = 0.2f;
-                b = 0.6f;
-            } else if (height < 0.3f) {
-                r = 0.1f;
-                g = 0.6f;
-                b = 0.2f;
-            } else {
-                r = 0.5f;
-                g = 0.35f;
-                b = 0.2f;
-            }
-            vertices[v++] = r;
-            vertices[v++] = g;
-            vertices[v++] = b;
-        }
+    const int vertsPerSide = TerrainScene::kVertsPerSide;
+    {
+        startup::Phase phase("terrain gen");
+        scene.Build(vertsPerSide, TerrainScene::kCellSize);
     }
 
-    // Generate indices
-    int k = 0;
-    for (int z = 0; z < vertsPerSide - 1; ++z) {
-        for (int x = 0; x < vertsPerSide - 1; ++x) {
-            unsigned int i0 = z * vertsPerSide + x;
-            unsigned int i1 = i0 + 1;
-            unsigned int i2 = i0 + vertsPerSide;
-            unsigned int i3 = i2 + 1;
-            indices[k++] = i0;
-            indices[k++] = i2;
-            indices[k++] = i1;
-            indices[k++] = i1;
-            indices[k++] = i2;
-            indices[k++] = i3;
-        }
-    }
-
-    gridIndicesCount = indexCount;
+    // Each vertex: position (3) + color (3). The CPU copy is kept to stage edited vertices.
+    startup::Phase phase("terrain vertices");
+    const int vertexCount = vertsPerSide * vertsPerSide;
+    terrainVertices.resize(static_cast<std::size_t>(vertexCount) * kTerrainVertexStride);
+    WriteTerrainVertices({0, static_cast<std::uint32_t>(vertexCount)});
+}
 
+void Renderer::CreateGrid() {
+    // Storage only; the contents are streamed in by the uploader over the next frames
     unsigned int VBO, EBO;
     glGenVertexArrays(1, &gridVAO);
     glGenBuffers(1, &VBO);
@@ -205,23 +135,171 @@ void Renderer::CreateGrid() {
     glGenBuffers(1, &EBO);
     terrainEBO = EBO;
 
+    // Dynamic: terrain edits rewrite parts of both buffers
     glBindVertexArray(gridVAO);
     glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
     glBufferData(
-        GL_ARRAY_BUFFER, vertexCount * vertexStride * sizeof(float), vertices, GL_STATIC_DRAW);
+        GL_ARRAY_BUFFER, terrainVertices.size() * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
 
+    // Indices come from the scene's tile meshes, tile after tile
+    const std::vector<std::uint32_t>& indices = scene.MeshIndices();
+    gridIndicesCount = static_cast<int>(indices.size());
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainEBO);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 indices.size() * sizeof(std::uint32_t),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
 
+    const int vertexStride = kTerrainVertexStride;
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(
         1, 3, GL_FLOAT, GL_FALSE, vertexStride * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    uploader.Enqueue(terrainVBO, 0, terrainVertices.data(), terrainVertices.size() * sizeof(float));
+    uploader.Enqueue(terrainEBO, 0, indices.data(), indices.size() * sizeof(std::uint32_t));
+}
+
+void Renderer::PumpStartup() {
+    if (loadStage == LoadStage::kReady)
+        return;
+    if (!shaderProgram && shaderTask.Done())
+        shaderProgram = BuildShaderProgram();
+    if (loadStage == LoadStage::kLoading && terrainTask.Done()) {
+        loadStage = LoadStage::kUploading;
+        uploadStartMs = startup::MillisecondsSinceBegin();
+        CreateGrid();
+    }
+    if (loadStage != LoadStage::kUploading)
+        return;
+
+    const double pumpStartMs = startup::MillisecondsSinceBegin();
+    uploadBytes += uploader.Pump(kUploadBytesPerFrame);
+    uploadMainMs += startup::MillisecondsSinceBegin() - pumpStartMs;
+    ++uploadFrames;
+    if (uploader.Idle() && shaderProgram) {
+        startup::Record("upload", uploadStartMs);
+        LOG_INFO("Terrain upload: %zu KB over %d frames, %.2f ms on the main thread",
+                 uploadBytes / 1024,
+                 uploadFrames,
+                 uploadMainMs);
+        loadStage = LoadStage::kReady;
+        startup::Finish();
+    }
+}
+
+const char* Renderer::LoadingStatus() const {
+    if (loadStage == LoadStage::kLoading)
+        return shaderProgram ? "Generating terrain" : "Loading shaders and terrain";
+    if (loadStage == LoadStage::kUploading)
+        return uploader.Idle() ? "Loading shaders" : "Uploading terrain";
+    return "Ready";
+}
 
-    delete[] vertices;
-    delete[] indices;
+float Renderer::LoadingProgress() const {
+    if (loadStage != LoadStage::kUploading)
+        return loadStage == LoadStage::kReady ? 1.0f : 0.0f;
+    const std::size_t pending = uploader.PendingBytes();
+    return uploadBytes + pending > 0 ? static_cast<float>(uploadBytes) / (uploadBytes + pending)
+                                     : 1.0f;
+}
+
+void Renderer::WriteTerrainVertices(const BufferSpan& span) {
+    const Heightfield& heightfield = scene.GetHeightfield();
+    const int vertsPerSide = heightfield.Size();
+    const float cellSize = heightfield.CellSize();
+    float* out =
+        terrainVertices.data() + static_cast<std::size_t>(span.first) * kTerrainVertexStride;
+    for (std::uint32_t i = span.first; i < span.first + span.count; ++i) {
+        const int x = static_cast<int>(i) % vertsPerSide;
+        const int z = static_cast<int>(i) / vertsPerSide;
+        const float height = heightfield.At(x, z);
+
+        // position
+        *out++ = heightfield.OriginX() + x * cellSize;  // x
+        *out++ = height;                                 // y
+        *out++ = heightfield.OriginZ() + z * cellSize;  // z
+        // color based on height: low=blueish, mid=green, high=brownish
+        float r = 0, g = 0, b = 0;
+        if (height < -0.5f) {
+            r = 0.1f;
+            g = 0.2f;
+            b = 0.6f;
+        } else if (height < 0.3f) {
+            r = 0.1f;
+            g = 0.6f;
+            b = 0.2f;
+        } else {
+            r = 0.5f;
+            g = 0.35f;
+            b = 0.2f;
+        }
+        *out++ = r;
+        *out++ = g;
+        *out++ = b;
+    }
+}
+
+void Renderer::UploadTerrainIndices() {
+    // Expects the grid's VAO bound, which carries the element buffer binding
+    const std::vector<std::uint32_t>& indices = scene.MeshIndices();
+    gridIndicesCount = static_cast<int>(indices.size());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 indices.size() * sizeof(std::uint32_t),
+                 indices.data(),
+                 GL_DYNAMIC_DRAW);
+}
+
+void Renderer::UploadTerrainEdits() {
+    const TerrainUpdate& update = scene.FlushEdits();
+    editStats = {};
+    editStats.stamps = update.stamps;
+    editStats.tilesRemeshed = update.tilesRemeshed;
+    editStats.cpuMs = update.cpuMs;
+    if (update.Empty())
+        return;
+
+    // Vertices are rebuilt into the CPU copy and only the changed spans are sent
+    glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
+    for (const BufferSpan& span : update.vertexSpans) {
+        WriteTerrainVertices(span);
+        const std::size_t stride = kTerrainVertexStride * sizeof(float);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        span.first * stride,
+                        span.count * stride,
+                        terrainVertices.data() + static_cast<std::size_t>(span.first) *
+                                                     kTerrainVertexStride);
+        ++editStats.uploadCalls;
+        editStats.uploadBytes += span.count * stride;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(gridVAO);
+    const std::vector<std::uint32_t>& indices = scene.MeshIndices();
+    if (update.indicesRelaid) {
+        UploadTerrainIndices();
+        ++editStats.uploadCalls;
+        editStats.uploadBytes += indices.size() * sizeof(std::uint32_t);
+    }
+    for (const BufferSpan& span : update.indexSpans) {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                        span.first * sizeof(std::uint32_t),
+                        span.count * sizeof(std::uint32_t),
+                        indices.data() + span.first);
+        ++editStats.uploadCalls;
+        editStats.uploadBytes += span.count * sizeof(std::uint32_t);
+    }
+    glBindVertexArray(0);
+}
+
+void Renderer::SetTerrainMesh(bool adaptive, float maxError) {
+    alloc::Scope allocScope("Terrain");
+    scene.BuildMesh(adaptive, std::clamp(maxError, 0.0f, kMaxTerrainMeshError));
+    glBindVertexArray(gridVAO);
+    UploadTerrainIndices();
+    glBindVertexArray(0);
 }
 
 void Renderer::CreateCube() {
@@ -294,30 +372,20 @@ void Renderer::UpdateTracerNDC(float x1, float y1, float x2, float y2) {
 }
 
 void Renderer::Render(const Camera& camera, Color& color) {
+    alloc::Scope allocScope("Render");
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Create view matrix
-    float cosYaw = cos(camera.yaw), sinYaw = sin(camera.yaw);
-    float cosPitch = cos(camera.pitch), sinPitch = sin(camera.pitch);
-
-    float viewMatrix[16] = {
-        cosYaw,
-        sinPitch * sinYaw,
-        -cosPitch * sinYaw,
-        0.0f,
-        0.0f,
-        cosPitch,
-        sinPitch,
-        0.0f,
-        sinYaw,
-        -sinPitch * cosYaw,
-        cosPitch * cosYaw,
-        0.0f,
-        -camera.x * cosYaw - camera.z * sinYaw,
-        -camera.x * sinPitch * sinYaw - camera.y * cosPitch + camera.z * sinPitch * cosYaw,
-        camera.x * cosPitch * sinYaw - camera.y * sinPitch - camera.z * cosPitch * cosYaw,
-        1.0f};
+    // Until startup finishes the cleared frame is the placeholder
+    PumpStartup();
+    if (loadStage != LoadStage::kReady)
+        return;
+
+    // Pick up this frame's terrain edits before culling, which reads the tile bounds
+    UploadTerrainEdits();
+
+    float viewMatrix[16];
+    BuildViewMatrix(camera, viewMatrix);
 
     // Build perspective projection based on current viewport aspect ratio
     GLint viewportForProj[4];
@@ -325,28 +393,47 @@ void Renderer::Render(const Camera& camera, Color& color) {
     int projW = viewportForProj[2];
     int projH = viewportForProj[3];
     float aspect = (projH != 0) ? (float)projW / (float)projH : 1.0f;
-    float fovY = 60.0f * (3.1415926535f / 180.0f);
+    if (aspectOverride > 0.0f)
+        aspect = aspectOverride;
+    float fovY = kCameraFovY;
     float f = 1.0f / tanf(fovY * 0.5f);
-    float zNear = 0.1f;
-    float zFar = 100.0f;
-    float A = (zFar + zNear) / (zNear - zFar);
-    float B = (2.0f * zFar * zNear) / (zNear - zFar);
-    float projMatrix[16] = {f / aspect,
-                            0.0f,
-                            0.0f,
-                            0.0f,
-                            0.0f,
-                            f,
-                            0.0f,
-                            0.0f,
-                            0.0f,
-                            0.0f,
-                            A,
-                            -1.0f,
-                            0.0f,
-                            0.0f,
-                            B,
-                            0.0f};
+    float zNear = kCameraNear;
+    float zFar = kCameraFar;
+    float projMatrix[16];
+    BuildProjectionMatrix(fovY, aspect, zNear, zFar, projMatrix);
+
+    // Cull terrain tiles and the cube
+    float viewProj[16];
+    MultiplyMatrices(projMatrix, viewMatrix, viewProj);
+    const Bounds cubeBounds = {-0.1f, -0.1f, -0.1f, 0.1f, 0.1f, 0.1f};
+    const std::uint8_t* cullVisible = scene.Cull(camera, viewProj, zNear, &cubeBounds, 1);
+    const std::size_t tileCount = scene.Tiles().size();
+
+    // Merge runs of visible tiles into index ranges for a single multi-draw
+    LinearArena& arena = frame::Arena();
+    GLsizei* drawCounts = arena.AllocateArray<GLsizei>(tileCount);
+    const void** drawOffsets = arena.AllocateArray<const void*>(tileCount);
+    GLsizei drawCount = 0;
+    const std::vector<TileMesh>& tileMeshes = scene.TileMeshes();
+    for (std::size_t i = 0; i < tileCount; ++i) {
+        if (!cullVisible[i])
+            continue;
+        // Whole ranges including padding, so adjacent tiles stay contiguous
+        if (i > 0 && cullVisible[i - 1]) {
+            drawCounts[drawCount - 1] += tileMeshes[i].capacity;
+            continue;
+        }
+        drawCounts[drawCount] = tileMeshes[i].capacity;
+        drawOffsets[drawCount] = reinterpret_cast<const void*>(
+            static_cast<std::size_t>(tileMeshes[i].firstIndex) * sizeof(std::uint32_t));
+        ++drawCount;
+    }
+
+    cullingStats = scene.GetCullingStats();
+    cullingStats.cubeVisible = cullVisible[tileCount] != 0;
+    cullingStats.drawCalls = drawCount;
+    if (cullingStats.cubeVisible)
+        cullingStats.triangles += 12;
 
     glUseProgram(shaderProgram);
     GLint viewLoc = glGetUniformLocation(shaderProgram, "uView");
@@ -356,15 +443,18 @@ void Renderer::Render(const Camera& camera, Color& color) {
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, viewMatrix);
     glUniformMatrix4fv(projLoc, 1, GL_FALSE, projMatrix);
 
-    // Draw terrain grid
+    // Draw visible terrain tiles
     glUniform3f(colorLoc, 1.0f, 1.0f, 1.0f);
     glBindVertexArray(gridVAO);
-    glDrawElements(GL_TRIANGLES, gridIndicesCount, GL_UNSIGNED_INT, 0);
+    if (drawCount > 0)
+        glMultiDrawElements(GL_TRIANGLES, drawCounts, GL_UNSIGNED_INT, drawOffsets, drawCount);
 
     // Draw cube
-    glUniform3f(colorLoc, color.r, color.g, color.b);
-    glBindVertexArray(cubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    if (cullingStats.cubeVisible) {
+        glUniform3f(colorLoc, color.r, color.g, color.b);
+        glBindVertexArray(cubeVAO);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    }
 
     // Compute cube center in world space (cube at origin)
     float cubeWorld[4] = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -422,8 +512,34 @@ void Renderer::Render(const Camera& camera, Color& color) {
         ndcCursorY = 0.0f;
     }
 
+    // Pick the terrain under the cursor: unproject the cursor NDC into a world-space ray.
+    // The view rotation is orthonormal, so its transpose takes view directions back to world.
+    float viewDir[3] = {ndcCursorX * aspect / f, ndcCursorY / f, -1.0f};
+    Ray pickRay{camera.x,
+                camera.y,
+                camera.z,
+                viewMatrix[0] * viewDir[0] + viewMatrix[1] * viewDir[1] + viewMatrix[2] * viewDir[2],
+                viewMatrix[4] * viewDir[0] + viewMatrix[5] * viewDir[1] + viewMatrix[6] * viewDir[2],
+                viewMatrix[8] * viewDir[0] + viewMatrix[9] * viewDir[1] + viewMatrix[10] * viewDir[2]};
+    lastPick = scene.GetRaycaster().Cast(pickRay, zFar);
+
+    // Tracer runs from the cube to the picked terrain point, or from the cursor to the cube
+    float tracerStartX = ndcCursorX, tracerStartY = ndcCursorY;
+    float tracerEndX = ndcCubeX, tracerEndY = ndcCubeY;
+    if (lastPick.hit) {
+        float pickWorld[4] = {lastPick.x, lastPick.y, lastPick.z, 1.0f};
+        mul4x4(viewMatrix, pickWorld, clip1);
+        mul4x4(projMatrix, clip1, clip2);
+        if (clip2[3] > 0.0f) {
+            tracerStartX = ndcCubeX;
+            tracerStartY = ndcCubeY;
+            tracerEndX = clip2[0] / clip2[3];
+            tracerEndY = clip2[1] / clip2[3];
+        }
+    }
+
     // Update and draw tracer as overlay in screen space (disable depth test so it draws on top)
-    UpdateTracerNDC(ndcCursorX, ndcCursorY, ndcCubeX, ndcCubeY);
+    UpdateTracerNDC(tracerStartX, tracerStartY, tracerEndX, tracerEndY);
     float identityMatrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, identityMatrix);
     glUniformMatrix4fv(projLoc, 1, GL_FALSE, identityMatrix);
@@ -467,5 +583,8 @@ void Renderer::Render(const Camera& camera, Color& color) {
 }
 
 void Renderer::Cleanup() {
-    // Nothing to do here for GLFW-managed context
+    // Startup tasks write into the renderer, so they must finish before it goes away
+    shaderTask.Wait();
+    terrainTask.Wait();
+    uploader.Shutdown();
 }
@@ -0,0 +1,340 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "frame_arena.h"
+#include "logger.h"
+#include "terrain_scene.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'O', 'T', 'R', 'P'};
+constexpr std::uint32_t kVersion = 1;
+// Header: magic, version, frame count, aspect, start camera. Frame: time, keys, look, camera.
+constexpr std::size_t kHeaderSize = 4 + 4 + 4 + 4 + 6 * 4;
+constexpr std::size_t kFrameSize = 8 + 1 + 2 * 4 + 6 * 4;
+
+class Writer {
+  public:
+    explicit Writer(std::string& out) : out(out) {}
+    void U8(std::uint8_t v) {
+        out.push_back(static_cast<char>(v));
+    }
+    void U32(std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            U8(static_cast<std::uint8_t>(v >> (i * 8)));
+        }
+    }
+    void U64(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            U8(static_cast<std::uint8_t>(v >> (i * 8)));
+        }
+    }
+    void F32(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        U32(bits);
+    }
+    void F64(double v) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        U64(bits);
+    }
+    void Cam(const Camera& c) {
+        for (float v : {c.x, c.y, c.z, c.pitch, c.yaw, c.speed}) {
+            F32(v);
+        }
+    }
+
+  private:
+    std::string& out;
+};
+
+// Reads from a buffer whose size the caller has already validated
+class Reader {
+  public:
+    explicit Reader(const char* data) : data(reinterpret_cast<const unsigned char*>(data)) {}
+    std::uint8_t U8() {
+        return data[pos++];
+    }
+    std::uint32_t U32() {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            v |= static_cast<std::uint32_t>(U8()) << (i * 8);
+        }
+        return v;
+    }
+    std::uint64_t U64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= static_cast<std::uint64_t>(U8()) << (i * 8);
+        }
+        return v;
+    }
+    float F32() {
+        const std::uint32_t bits = U32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    double F64() {
+        const std::uint64_t bits = U64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    Camera Cam() {
+        Camera c;
+        c.x = F32();
+        c.y = F32();
+        c.z = F32();
+        c.pitch = F32();
+        c.yaw = F32();
+        c.speed = F32();
+        return c;
+    }
+
+  private:
+    const unsigned char* data;
+    std::size_t pos = 0;
+};
+
+double Percentile(std::vector<double>& values, double p) {
+    if (values.empty())
+        return 0.0;
+    const std::size_t index =
+        std::min(values.size() - 1, static_cast<std::size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+}  // namespace
+
+namespace replay {
+
+bool Save(const std::string& path, const Recording& recording) {
+    std::string bytes;
+    bytes.reserve(kHeaderSize + recording.frames.size() * kFrameSize);
+    Writer w(bytes);
+    for (char c : kMagic) {
+        w.U8(static_cast<std::uint8_t>(c));
+    }
+    w.U32(kVersion);
+    w.U32(static_cast<std::uint32_t>(recording.frames.size()));
+    w.F32(recording.aspect);
+    w.Cam(recording.start);
+    for (const RecordedFrame& frame : recording.frames) {
+        w.F64(frame.time);
+        w.U8(frame.input.keys);
+        w.F32(frame.input.lookX);
+        w.F32(frame.input.lookY);
+        w.Cam(frame.camera);
+    }
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open()) {
+        LOG_ERROR("Failed to write recording %s", path.c_str());
+        return false;
+    }
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    LOG_INFO("Saved recording %s: %zu frames, %zu bytes",
+             path.c_str(),
+             recording.frames.size(),
+             bytes.size());
+    return static_cast<bool>(ofs);
+}
+
+bool Load(const std::string& path, Recording& recording) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        LOG_ERROR("Failed to open recording %s", path.c_str());
+        return false;
+    }
+    const std::string bytes{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+    if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic, 4) != 0) {
+        LOG_ERROR("%s is not a recording", path.c_str());
+        return false;
+    }
+    Reader r(bytes.data() + 4);
+    const std::uint32_t version = r.U32();
+    if (version != kVersion) {
+        LOG_ERROR("Recording %s has unsupported version %u", path.c_str(), version);
+        return false;
+    }
+    const std::uint32_t frameCount = r.U32();
+    if (bytes.size() < kHeaderSize + static_cast<std::size_t>(frameCount) * kFrameSize) {
+        LOG_ERROR("Recording %s is truncated", path.c_str());
+        return false;
+    }
+    recording.aspect = r.F32();
+    recording.start = r.Cam();
+    recording.frames.resize(frameCount);
+    for (RecordedFrame& frame : recording.frames) {
+        frame.time = r.F64();
+        frame.input.keys = r.U8();
+        frame.input.lookX = r.F32();
+        frame.input.lookY = r.F32();
+        frame.camera = r.Cam();
+    }
+    LOG_INFO("Loaded recording %s: %u frames", path.c_str(), frameCount);
+    return true;
+}
+
+float Drift(const Camera& a, const Camera& b) {
+    return std::max({std::fabs(a.x - b.x),
+                     std::fabs(a.y - b.y),
+                     std::fabs(a.z - b.z),
+                     std::fabs(a.pitch - b.pitch),
+                     std::fabs(a.yaw - b.yaw)});
+}
+
+bool WriteTimings(const std::string& path, const std::vector<FrameTiming>& timings) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("Failed to write timings %s", path.c_str());
+        return false;
+    }
+#ifdef TRACK_GL_CALLS
+    std::fprintf(file,
+                 "frame,cpu_ms,gpu_ms,cull_ms,triangles,draw_calls,gl_calls,gl_sync_calls,"
+                 "upload_bytes\n");
+#else
+    std::fprintf(file, "frame,cpu_ms,gpu_ms,cull_ms,triangles,draw_calls\n");
+#endif
+    for (std::size_t i = 0; i < timings.size(); ++i) {
+        const FrameTiming& t = timings[i];
+        if (t.gpuMs >= 0.0)
+            std::fprintf(file, "%zu,%.4f,%.4f", i, t.cpuMs, t.gpuMs);
+        else
+            std::fprintf(file, "%zu,%.4f,", i, t.cpuMs);
+#ifdef TRACK_GL_CALLS
+        std::fprintf(file,
+                     ",%.4f,%d,%d,%llu,%llu,%llu\n",
+                     t.cullMs,
+                     t.triangles,
+                     t.drawCalls,
+                     static_cast<unsigned long long>(t.glCalls),
+                     static_cast<unsigned long long>(t.glSyncCalls),
+                     static_cast<unsigned long long>(t.uploadBytes));
+#else
+        std::fprintf(file, ",%.4f,%d,%d\n", t.cullMs, t.triangles, t.drawCalls);
+#endif
+    }
+    std::fclose(file);
+    LOG_INFO("Wrote %zu frame timings to %s", timings.size(), path.c_str());
+    return true;
+}
+
+void LogSummary(const std::vector<FrameTiming>& timings) {
+    if (timings.empty())
+        return;
+    std::vector<double> cpu, gpu, cull;
+    double triangles = 0.0;
+    for (const FrameTiming& t : timings) {
+        cpu.push_back(t.cpuMs);
+        cull.push_back(t.cullMs);
+        if (t.gpuMs >= 0.0)
+            gpu.push_back(t.gpuMs);
+        triangles += t.triangles;
+    }
+    LOG_INFO("[replay] %zu frames, %.0f triangles/frame on average",
+             timings.size(),
+             triangles / timings.size());
+    LOG_INFO("[replay] CPU ms: p50 %.3f, p95 %.3f, p99 %.3f",
+             Percentile(cpu, 0.5),
+             Percentile(cpu, 0.95),
+             Percentile(cpu, 0.99));
+    LOG_INFO("[replay] culling ms: p50 %.3f, p95 %.3f, p99 %.3f",
+             Percentile(cull, 0.5),
+             Percentile(cull, 0.95),
+             Percentile(cull, 0.99));
+    if (!gpu.empty()) {
+        LOG_INFO("[replay] GPU ms: p50 %.3f, p95 %.3f, p99 %.3f",
+                 Percentile(gpu, 0.5),
+                 Percentile(gpu, 0.95),
+                 Percentile(gpu, 0.99));
+    }
+#ifdef TRACK_GL_CALLS
+    // The headless replay makes no GL calls
+    std::vector<double> glCalls;
+    double syncCalls = 0.0, uploadBytes = 0.0;
+    for (const FrameTiming& t : timings) {
+        glCalls.push_back(static_cast<double>(t.glCalls));
+        syncCalls += static_cast<double>(t.glSyncCalls);
+        uploadBytes += static_cast<double>(t.uploadBytes);
+    }
+    if (Percentile(glCalls, 1.0) > 0.0) {
+        LOG_INFO("[replay] GL calls/frame: p50 %.0f, p95 %.0f, max %.0f; %.1f sync calls and "
+                 "%.1f KB uploaded per frame",
+                 Percentile(glCalls, 0.5),
+                 Percentile(glCalls, 0.95),
+                 Percentile(glCalls, 1.0),
+                 syncCalls / timings.size(),
+                 uploadBytes / 1024.0 / timings.size());
+    }
+#endif
+}
+
+int RunHeadless(const std::string& recordingPath, const std::string& timingsPath) {
+    Recording recording;
+    if (!Load(recordingPath, recording))
+        return 1;
+
+    TerrainScene scene;
+    scene.Build(TerrainScene::kVertsPerSide, TerrainScene::kCellSize);
+    float projection[16];
+    BuildProjectionMatrix(kCameraFovY, recording.aspect, kCameraNear, kCameraFar, projection);
+    const Bounds cubeBounds = {-0.1f, -0.1f, -0.1f, 0.1f, 0.1f, 0.1f};
+
+    std::vector<FrameTiming> timings(recording.frames.size());
+    Camera camera = recording.start;
+    float maxDrift = 0.0f;
+    for (std::size_t i = 0; i < recording.frames.size(); ++i) {
+        const RecordedFrame& recorded = recording.frames[i];
+        frame::BeginFrame();
+        const auto start = std::chrono::steady_clock::now();
+
+        ApplyInput(recorded.input, scene.GetHeightfield(), camera);
+        maxDrift = std::max(maxDrift, Drift(camera, recorded.camera));
+        // The recorded camera is authoritative, so every build sees exactly the same views
+        camera = recorded.camera;
+
+        float view[16], viewProj[16];
+        BuildViewMatrix(camera, view);
+        MultiplyMatrices(projection, view, viewProj);
+        const std::uint8_t* visible = scene.Cull(camera, viewProj, kCameraNear, &cubeBounds, 1);
+        // Crosshair pick along the view direction, as the renderer does with a captured mouse
+        const Ray pickRay{camera.x, camera.y, camera.z, -view[2], -view[6], -view[10]};
+        scene.GetRaycaster().Cast(pickRay, kCameraFar);
+
+        const CullingStats& stats = scene.GetCullingStats();
+        const std::size_t tileCount = scene.Tiles().size();
+        FrameTiming& timing = timings[i];
+        timing.cullMs = stats.cpuMs;
+        timing.triangles = stats.triangles + (visible[tileCount] ? 12 : 0);
+        for (std::size_t t = 0; t < tileCount; ++t) {
+            if (visible[t] && (t == 0 || !visible[t - 1]))
+                ++timing.drawCalls;
+        }
+        timing.cpuMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    }
+
+    LOG_INFO("[replay] headless replay of %s, max camera drift %g",
+             recordingPath.c_str(),
+             maxDrift);
+    LogSummary(timings);
+    if (!timingsPath.empty())
+        WriteTimings(timingsPath, timings);
+    return 0;
+}
+
+}  // namespace replay
@@ -0,0 +1,79 @@
+#include "staged_upload.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "gl_hooks.h"
+
+void StagedUploader::Initialize(std::size_t bytes) {
+    sliceBytes = bytes;
+    glGenBuffers(1, &staging);
+    glBindBuffer(GL_COPY_READ_BUFFER, staging);
+    glBufferData(
+        GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(sliceBytes), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void StagedUploader::Shutdown() {
+    if (staging)
+        glDeleteBuffers(1, &staging);
+    staging = 0;
+    queue.clear();
+}
+
+void StagedUploader::Enqueue(unsigned int buffer,
+                             std::size_t offset,
+                             const void* data,
+                             std::size_t bytes) {
+    if (bytes > 0)
+        queue.push_back({buffer, offset, static_cast<const unsigned char*>(data), bytes, 0});
+}
+
+std::size_t StagedUploader::Pump(std::size_t budgetBytes) {
+    std::size_t sent = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, staging);
+    while (!queue.empty() && sent < budgetBytes) {
+        Pending& pending = queue.front();
+        const std::size_t bytes = std::min(sliceBytes, pending.bytes - pending.sent);
+        const unsigned char* source = pending.data + pending.sent;
+        const auto destination = static_cast<GLintptr>(pending.offset + pending.sent);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pending.buffer);
+        void* mapped = glMapBufferRange(GL_COPY_READ_BUFFER,
+                                        0,
+                                        static_cast<GLsizeiptr>(bytes),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        bool staged = false;
+        if (mapped) {
+            std::memcpy(mapped, source, bytes);
+            staged = glUnmapBuffer(GL_COPY_READ_BUFFER) == GL_TRUE;
+        }
+        if (staged) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER,
+                                GL_COPY_WRITE_BUFFER,
+                                0,
+                                destination,
+                                static_cast<GLsizeiptr>(bytes));
+        } else {
+            // Mapping failed or the staging contents were lost: fall back to a direct upload
+            glBufferSubData(
+                GL_COPY_WRITE_BUFFER, destination, static_cast<GLsizeiptr>(bytes), source);
+        }
+        pending.sent += bytes;
+        sent += bytes;
+        if (pending.sent == pending.bytes)
+            queue.pop_front();
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return sent;
+}
+
+std::size_t StagedUploader::PendingBytes() const {
+    std::size_t bytes = 0;
+    for (const Pending& pending : queue) {
+        bytes += pending.bytes - pending.sent;
+    }
+    return bytes;
+}
@@ -0,0 +1,73 @@
+#include "startup.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "logger.h"
+
+namespace {
+
+struct PhaseRecord {
+    const char* name;
+    double startMs, endMs;
+    bool mainThread;
+};
+
+constexpr int kMaxPhases = 32;
+
+std::chrono::steady_clock::time_point beginTime = std::chrono::steady_clock::now();
+std::thread::id mainThread = std::this_thread::get_id();
+std::mutex phaseMutex;
+PhaseRecord phases[kMaxPhases];
+int phaseCount = 0;
+double firstFrameMs = -1.0;
+bool finished = false;
+
+}  // namespace
+
+namespace startup {
+
+void Begin() {
+    beginTime = std::chrono::steady_clock::now();
+    mainThread = std::this_thread::get_id();
+}
+
+double MillisecondsSinceBegin() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime)
+        .count();
+}
+
+void Record(const char* name, double startMs) {
+    const double endMs = MillisecondsSinceBegin();
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    if (finished || phaseCount == kMaxPhases)
+        return;
+    phases[phaseCount++] = {name, startMs, endMs, std::this_thread::get_id() == mainThread};
+}
+
+void MarkFirstFrame() {
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    if (firstFrameMs < 0.0)
+        firstFrameMs = MillisecondsSinceBegin();
+}
+
+void Finish() {
+    const double readyMs = MillisecondsSinceBegin();
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    if (finished)
+        return;
+    finished = true;
+    LOG_INFO("Startup: first frame after %.1f ms, ready after %.1f ms", firstFrameMs, readyMs);
+    for (int i = 0; i < phaseCount; ++i) {
+        const PhaseRecord& phase = phases[i];
+        LOG_INFO("Startup:   %-16s %8.2f ms  (%.1f - %.1f ms, %s)",
+                 phase.name,
+                 phase.endMs - phase.startMs,
+                 phase.startMs,
+                 phase.endMs,
+                 phase.mainThread ? "main thread" : "worker");
+    }
+}
+
+}  // namespace startup
@@ -0,0 +1,107 @@
+#include "terrain_edit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "heightfield.h"
+
+GridRect Union(const GridRect& a, const GridRect& b) {
+    if (a.Empty())
+        return b;
+    if (b.Empty())
+        return a;
+    return {std::min(a.minX, b.minX),
+            std::min(a.minZ, b.minZ),
+            std::max(a.maxX, b.maxX),
+            std::max(a.maxZ, b.maxZ)};
+}
+
+GridRect Expand(const GridRect& rect, int amount, int limit) {
+    if (rect.Empty())
+        return rect;
+    return {std::max(0, rect.minX - amount),
+            std::max(0, rect.minZ - amount),
+            std::min(limit, rect.maxX + amount),
+            std::min(limit, rect.maxZ + amount)};
+}
+
+GridRect ApplyBrush(Heightfield& field, const Brush& brush) {
+    if (field.Empty() || brush.radius <= 0.0f)
+        return {};
+    const float invCell = 1.0f / field.CellSize();
+    const float gx = (brush.x - field.OriginX()) * invCell;
+    const float gz = (brush.z - field.OriginZ()) * invCell;
+    const float gr = brush.radius * invCell;
+    const int last = field.Size() - 1;
+    GridRect rect{std::max(0, static_cast<int>(std::ceil(gx - gr))),
+                  std::max(0, static_cast<int>(std::ceil(gz - gr))),
+                  std::min(last, static_cast<int>(std::floor(gx + gr))),
+                  std::min(last, static_cast<int>(std::floor(gz + gr)))};
+    if (rect.Empty())
+        return {};
+
+    const float invRadius2 = 1.0f / (gr * gr);
+    for (int z = rect.minZ; z <= rect.maxZ; ++z) {
+        const float dz = z - gz;
+        for (int x = rect.minX; x <= rect.maxX; ++x) {
+            const float dx = x - gx;
+            const float d2 = (dx * dx + dz * dz) * invRadius2;
+            if (d2 >= 1.0f)
+                continue;
+            // (1 - d^2)^2: smooth at the centre and flat where it meets the untouched terrain
+            const float weight = (1.0f - d2) * (1.0f - d2);
+            const float h = field.At(x, z);
+            switch (brush.mode) {
+                case BrushMode::kRaise:
+                    field.SetHeight(x, z, h + brush.strength * weight);
+                    break;
+                case BrushMode::kLower:
+                    field.SetHeight(x, z, h - brush.strength * weight);
+                    break;
+                case BrushMode::kFlatten:
+                    field.SetHeight(x, z, h + (brush.height - h) * brush.strength * weight);
+                    break;
+            }
+        }
+    }
+    return rect;
+}
+
+void DirtyRegions::Add(const GridRect& rect) {
+    if (rect.Empty())
+        return;
+    // Absorb every rectangle the new one overlaps or touches; the union can reach further ones
+    GridRect merged = rect;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 0; i < count; ++i) {
+            const GridRect& r = rects[i];
+            if (r.minX > merged.maxX + 1 || merged.minX > r.maxX + 1 || r.minZ > merged.maxZ + 1 ||
+                merged.minZ > r.maxZ + 1)
+                continue;
+            merged = Union(merged, r);
+            rects[i] = rects[--count];
+            changed = true;
+            break;
+        }
+    }
+    if (count < kMaxRects) {
+        rects[count++] = merged;
+        return;
+    }
+
+    std::size_t best = 0;
+    std::size_t bestGrowth = std::numeric_limits<std::size_t>::max();
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t growth = Union(rects[i], merged).Area() - rects[i].Area();
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    // The grown rectangle may now overlap others; re-adding it merges them
+    const GridRect grown = Union(rects[best], merged);
+    rects[best] = rects[--count];
+    Add(grown);
+}
@@ -0,0 +1,194 @@
+#include "terrain_mesher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "heightfield.h"
+#include "jobs.h"
+
+namespace {
+
+// The diagonal of the square centred on c (half-size s) runs from the corner it shares with the
+// centre of its parent square; per axis that corner is the odd multiple of 2s
+int DiagonalCorner(int c, int s) {
+    return ((c - s) / (2 * s)) & 1 ? c - s : c + s;
+}
+
+// Largest vertical distance between a grid vertex inside triangle abc (edges included) and the
+// triangle's plane
+float TriangleDeviation(const float* heights,
+                        int size,
+                        int ax,
+                        int az,
+                        int bx,
+                        int bz,
+                        int cx,
+                        int cz) {
+    auto height = [&](int x, int z) { return heights[static_cast<std::size_t>(z) * size + x]; };
+    const int area = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+    const float ha = height(ax, az), hb = height(bx, bz), hc = height(cx, cz);
+    const float invArea = 1.0f / static_cast<float>(area);
+    float deviation = 0.0f;
+    for (int z = std::min({az, bz, cz}); z <= std::max({az, bz, cz}); ++z) {
+        for (int x = std::min({ax, bx, cx}); x <= std::max({ax, bx, cx}); ++x) {
+            // Barycentric weights scaled by the signed area; all share its sign inside
+            const int wa = (bx - x) * (cz - z) - (bz - z) * (cx - x);
+            const int wb = (cx - x) * (az - z) - (cz - z) * (ax - x);
+            const int wc = area - wa - wb;
+            if ((area > 0 && (wa < 0 || wb < 0 || wc < 0)) ||
+                (area < 0 && (wa > 0 || wb > 0 || wc > 0)))
+                continue;
+            const float plane = (wa * ha + wb * hb + wc * hc) * invArea;
+            deviation = std::max(deviation, std::fabs(plane - height(x, z)));
+        }
+    }
+    return deviation;
+}
+
+}  // namespace
+
+void TerrainMesher::Build(const Heightfield& field, int cellsPerTile) {
+    size = field.Size();
+    tileCells = cellsPerTile;
+    errors.assign(static_cast<std::size_t>(size) * size, 0.0f);
+    ComputeErrors(field, {0, 0, size - 1, size - 1});
+}
+
+GridRect TerrainMesher::Update(const Heightfield& field, const GridRect& changed) {
+    ComputeErrors(field, changed);
+    return Expand(changed, 3 * (tileCells / 2), size - 1);
+}
+
+void TerrainMesher::ComputeErrors(const Heightfield& field, const GridRect& rect) {
+    const float* heights = field.Data();
+    // Triangles whose right angle falls outside the grid do not exist
+    auto deviation = [&](int ax, int az, int bx, int bz, int cx, int cz) {
+        if (cx < 0 || cz < 0 || cx >= size || cz >= size)
+            return 0.0f;
+        return TriangleDeviation(heights, size, ax, az, bx, bz, cx, cz);
+    };
+    auto error = [&](int x, int z) -> float& {
+        return errors[static_cast<std::size_t>(z) * size + x];
+    };
+    // First x >= from on the lattice start + k * step
+    auto firstAtOrAfter = [](int from, int start, int step) {
+        return from <= start ? start : start + (from - start + step - 1) / step * step;
+    };
+
+    // A vertex's error is the largest deviation of any grid vertex from the plane of the two
+    // triangles it splits, or of its children. Measuring every covered vertex rather than only
+    // the split point keeps the bound exact: deviations of the levels below do not simply add up.
+    // Levels run from the finest up to the tile halves. Each level only reads the one below, so
+    // the vertices of a level are independent and spread across the workers by row.
+    // A vertex of level s depends on heights up to 3s away through the levels below it, so
+    // after an edit only that margin around the changed heights is recomputed.
+    for (int s = 1; s <= tileCells / 2; s *= 2) {
+        const GridRect level = Expand(rect, 3 * s, size - 1);
+        const std::size_t rows = static_cast<std::size_t>(level.maxZ - level.minZ + 1);
+
+        // Edge midpoints: hypotenuse along an axis, children are the diagonal midpoints at s / 2
+        jobs::ParallelFor(rows, 16, [&](std::size_t begin, std::size_t end) {
+            const int zEnd = level.minZ + static_cast<int>(end);
+            for (int z = level.minZ + static_cast<int>(begin); z < zEnd; ++z) {
+                if (z % s != 0)
+                    continue;
+                const bool vertical = (z / s) & 1;
+                for (int x = firstAtOrAfter(level.minX, vertical ? 0 : s, 2 * s);
+                     x <= level.maxX && x < size;
+                     x += 2 * s) {
+                    float e = vertical
+                                  ? std::max(deviation(x, z - s, x, z + s, x - s, z),
+                                             deviation(x, z - s, x, z + s, x + s, z))
+                                  : std::max(deviation(x - s, z, x + s, z, x, z - s),
+                                             deviation(x - s, z, x + s, z, x, z + s));
+                    if (s > 1) {
+                        const int h = s / 2;
+                        for (int dz = -h; dz <= h; dz += 2 * h) {
+                            for (int dx = -h; dx <= h; dx += 2 * h) {
+                                const int cx = x + dx, cz = z + dz;
+                                if (cx >= 0 && cz >= 0 && cx < size && cz < size)
+                                    e = std::max(e, error(cx, cz));
+                            }
+                        }
+                    }
+                    error(x, z) = e;
+                }
+            }
+        });
+
+        // Square centres: hypotenuse along the square's diagonal, children are its edge midpoints
+        jobs::ParallelFor(rows, 16, [&](std::size_t begin, std::size_t end) {
+            const int zEnd = level.minZ + static_cast<int>(end);
+            for (int z = level.minZ + static_cast<int>(begin); z < zEnd; ++z) {
+                if (z % s != 0 || !((z / s) & 1))
+                    continue;
+                const int pz = DiagonalCorner(z, s);
+                for (int x = firstAtOrAfter(level.minX, s, 2 * s); x <= level.maxX && x < size;
+                     x += 2 * s) {
+                    const int px = DiagonalCorner(x, s);
+                    const int qx = 2 * x - px, qz = 2 * z - pz;
+                    error(x, z) = std::max({deviation(px, pz, qx, qz, px, qz),
+                                            deviation(px, pz, qx, qz, qx, pz),
+                                            error(x - s, z),
+                                            error(x + s, z),
+                                            error(x, z - s),
+                                            error(x, z + s)});
+                }
+            }
+        });
+    }
+}
+
+void TerrainMesher::AppendTile(const TerrainTile& tile,
+                               float maxError,
+                               std::vector<std::uint32_t>& indices) const {
+    const int s = tile.cells / 2;
+    const int cx = tile.cellX + s, cz = tile.cellZ + s;
+    const int px = DiagonalCorner(cx, s), pz = DiagonalCorner(cz, s);
+    const int qx = 2 * cx - px, qz = 2 * cz - pz;
+    // The two halves share the diagonal p-q; their right angles sit at the other two corners
+    Refine(px, pz, qx, qz, px, qz, maxError, indices);
+    Refine(qx, qz, px, pz, qx, pz, maxError, indices);
+}
+
+void TerrainMesher::Refine(int ax,
+                           int az,
+                           int bx,
+                           int bz,
+                           int cx,
+                           int cz,
+                           float maxError,
+                           std::vector<std::uint32_t>& indices) const {
+    // a-b is the hypotenuse, c the right angle; split at the hypotenuse midpoint while the
+    // triangle is larger than half a cell and dropping the midpoint would exceed the error
+    const int mx = (ax + bx) / 2, mz = (az + bz) / 2;
+    if (std::abs(ax - cx) + std::abs(az - cz) > 1 &&
+        errors[static_cast<std::size_t>(mz) * size + mx] > maxError) {
+        Refine(cx, cz, ax, az, mx, mz, maxError, indices);
+        Refine(bx, bz, cx, cz, mx, mz, maxError, indices);
+        return;
+    }
+    // Match the regular grid's winding (negative signed area in x/z)
+    if ((bx - ax) * (cz - az) - (bz - az) * (cx - ax) > 0) {
+        std::swap(bx, cx);
+        std::swap(bz, cz);
+    }
+    indices.push_back(static_cast<std::uint32_t>(az * size + ax));
+    indices.push_back(static_cast<std::uint32_t>(bz * size + bx));
+    indices.push_back(static_cast<std::uint32_t>(cz * size + cx));
+}
+
+void AppendRegularTile(const TerrainTile& tile,
+                       int vertsPerSide,
+                       std::vector<std::uint32_t>& indices) {
+    for (int z = tile.cellZ; z < tile.cellZ + tile.cells; ++z) {
+        for (int x = tile.cellX; x < tile.cellX + tile.cells; ++x) {
+            const std::uint32_t i0 = z * vertsPerSide + x;
+            const std::uint32_t i1 = i0 + 1;
+            const std::uint32_t i2 = i0 + vertsPerSide;
+            const std::uint32_t i3 = i2 + 1;
+            indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+        }
+    }
+}
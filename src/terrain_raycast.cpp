@@ -0,0 +1,240 @@
+#include "terrain_raycast.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "heightfield.h"
+#include "jobs.h"
+
+namespace {
+
+constexpr std::size_t kBatchGrain = 256;
+
+// Clip [tMin, tMax] to the slab lo <= start + step * t <= hi
+bool ClipSlab(float start, float step, float lo, float hi, float& tMin, float& tMax) {
+    if (std::fabs(step) < 1e-12f)
+        return start >= lo && start <= hi;
+    float ta = (lo - start) / step;
+    float tb = (hi - start) / step;
+    if (ta > tb)
+        std::swap(ta, tb);
+    tMin = std::max(tMin, ta);
+    tMax = std::min(tMax, tb);
+    return tMin <= tMax;
+}
+
+// Moller-Trumbore; returns the ray parameter or a negative value on a miss
+float IntersectTriangle(const Ray& ray, const float a[3], const float b[3], const float c[3]) {
+    const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    const float p[3] = {ray.dirY * e2[2] - ray.dirZ * e2[1],
+                        ray.dirZ * e2[0] - ray.dirX * e2[2],
+                        ray.dirX * e2[1] - ray.dirY * e2[0]};
+    const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::fabs(det) < 1e-12f)
+        return -1.0f;
+    const float invDet = 1.0f / det;
+    const float s[3] = {ray.originX - a[0], ray.originY - a[1], ray.originZ - a[2]};
+    const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return -1.0f;
+    const float q[3] = {
+        s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    const float v = (ray.dirX * q[0] + ray.dirY * q[1] + ray.dirZ * q[2]) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return -1.0f;
+    return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+}
+
+}  // namespace
+
+void TerrainRaycaster::Build(const Heightfield& heightfield) {
+    field = &heightfield;
+    levels.clear();
+
+    const int cells = heightfield.Size() - 1;
+    if (cells <= 0) {
+        field = nullptr;
+        return;
+    }
+
+    Level leaf;
+    leaf.width = cells;
+    leaf.height = cells;
+    leaf.maxHeights.resize(static_cast<std::size_t>(cells) * cells);
+    for (int z = 0; z < cells; ++z) {
+        for (int x = 0; x < cells; ++x) {
+            leaf.maxHeights[static_cast<std::size_t>(z) * cells + x] = CellMax(x, z);
+        }
+    }
+    levels.push_back(std::move(leaf));
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const Level& child = levels.back();
+        Level parent;
+        parent.width = (child.width + 1) / 2;
+        parent.height = (child.height + 1) / 2;
+        parent.maxHeights.resize(static_cast<std::size_t>(parent.width) * parent.height);
+        for (int z = 0; z < parent.height; ++z) {
+            for (int x = 0; x < parent.width; ++x) {
+                parent.maxHeights[static_cast<std::size_t>(z) * parent.width + x] =
+                    ChildrenMax(child, x, z);
+            }
+        }
+        levels.push_back(std::move(parent));
+    }
+}
+
+void TerrainRaycaster::Refresh(const GridRect& cells) {
+    if (!field || levels.empty())
+        return;
+    GridRect rect = Expand(cells, 0, levels[0].width - 1);
+    if (rect.Empty())
+        return;
+    Level& leaf = levels[0];
+    for (int z = rect.minZ; z <= rect.maxZ; ++z) {
+        for (int x = rect.minX; x <= rect.maxX; ++x) {
+            leaf.maxHeights[static_cast<std::size_t>(z) * leaf.width + x] = CellMax(x, z);
+        }
+    }
+    // Each level up halves the rectangle
+    for (std::size_t l = 1; l < levels.size(); ++l) {
+        rect = {rect.minX / 2, rect.minZ / 2, rect.maxX / 2, rect.maxZ / 2};
+        Level& level = levels[l];
+        for (int z = rect.minZ; z <= rect.maxZ; ++z) {
+            for (int x = rect.minX; x <= rect.maxX; ++x) {
+                level.maxHeights[static_cast<std::size_t>(z) * level.width + x] =
+                    ChildrenMax(levels[l - 1], x, z);
+            }
+        }
+    }
+}
+
+float TerrainRaycaster::CellMax(int x, int z) const {
+    return std::max(std::max(field->At(x, z), field->At(x + 1, z)),
+                    std::max(field->At(x, z + 1), field->At(x + 1, z + 1)));
+}
+
+float TerrainRaycaster::ChildrenMax(const Level& child, int x, int z) {
+    float m = -std::numeric_limits<float>::max();
+    for (int dz = 0; dz < 2; ++dz) {
+        for (int dx = 0; dx < 2; ++dx) {
+            const int cx = x * 2 + dx;
+            const int cz = z * 2 + dz;
+            if (cx < child.width && cz < child.height)
+                m = std::max(m, child.maxHeights[static_cast<std::size_t>(cz) * child.width + cx]);
+        }
+    }
+    return m;
+}
+
+bool TerrainRaycaster::IntersectCell(
+    const Ray& ray, int cellX, int cellZ, float tMin, float tMax, RayHit& hit) const {
+    const float cs = field->CellSize();
+    const float x0 = field->OriginX() + cellX * cs;
+    const float z0 = field->OriginZ() + cellZ * cs;
+    const float p00[3] = {x0, field->At(cellX, cellZ), z0};
+    const float p10[3] = {x0 + cs, field->At(cellX + 1, cellZ), z0};
+    const float p01[3] = {x0, field->At(cellX, cellZ + 1), z0 + cs};
+    const float p11[3] = {x0 + cs, field->At(cellX + 1, cellZ + 1), z0 + cs};
+
+    // Same split as the render mesh: (00, 01, 10) and (10, 01, 11)
+    float best = -1.0f;
+    for (float t : {IntersectTriangle(ray, p00, p01, p10), IntersectTriangle(ray, p10, p01, p11)}) {
+        if (t >= 0.0f && t >= tMin && t <= tMax && (best < 0.0f || t < best))
+            best = t;
+    }
+    if (best < 0.0f)
+        return false;
+    hit.hit = true;
+    hit.t = best;
+    hit.x = ray.originX + ray.dirX * best;
+    hit.y = ray.originY + ray.dirY * best;
+    hit.z = ray.originZ + ray.dirZ * best;
+    return true;
+}
+
+RayHit TerrainRaycaster::Cast(const Ray& ray, float maxT) const {
+    RayHit hit;
+    if (!field)
+        return hit;
+
+    // Work in grid space on XZ, where cell (i, j) spans [i, i + 1] x [j, j + 1]
+    const float invCell = 1.0f / field->CellSize();
+    const float gx = (ray.originX - field->OriginX()) * invCell;
+    const float gz = (ray.originZ - field->OriginZ()) * invCell;
+    const float stepX = ray.dirX * invCell;
+    const float stepZ = ray.dirZ * invCell;
+    const float cells = static_cast<float>(levels[0].width);
+
+    float t = 0.0f;
+    float tEnd = maxT;
+    if (!ClipSlab(gx, stepX, 0.0f, cells, t, tEnd) || !ClipSlab(gz, stepZ, 0.0f, cells, t, tEnd) ||
+        !ClipSlab(ray.originY,
+                  ray.dirY,
+                  field->MinHeight(),
+                  field->MaxHeight(),
+                  t,
+                  tEnd))
+        return hit;
+
+    // Nudge used to pick the node ahead of a boundary: a small fraction of one cell crossing
+    const float crossRate = std::max(std::fabs(stepX), std::fabs(stepZ));
+    const float nudge = crossRate > 0.0f ? 1e-4f / crossRate : 0.0f;
+    const int topLevel = static_cast<int>(levels.size()) - 1;
+    const int maxSteps = 4 * (levels[0].width + levels[0].height + 2) * (topLevel + 1);
+
+    int level = topLevel;
+    for (int step = 0; step < maxSteps && t <= tEnd; ++step) {
+        const Level& lv = levels[level];
+        const float probe = std::min(t + nudge, tEnd);
+        const int cellX = std::clamp(static_cast<int>(std::floor(gx + stepX * probe)), 0,
+                                     levels[0].width - 1);
+        const int cellZ = std::clamp(static_cast<int>(std::floor(gz + stepZ * probe)), 0,
+                                     levels[0].height - 1);
+        const int nodeX = cellX >> level;
+        const int nodeZ = cellZ >> level;
+
+        // Parameter where the ray leaves this node on XZ
+        const float span = static_cast<float>(1 << level);
+        float tExit = tEnd;
+        if (stepX > 0.0f)
+            tExit = std::min(tExit, ((nodeX + 1) * span - gx) / stepX);
+        else if (stepX < 0.0f)
+            tExit = std::min(tExit, (nodeX * span - gx) / stepX);
+        if (stepZ > 0.0f)
+            tExit = std::min(tExit, ((nodeZ + 1) * span - gz) / stepZ);
+        else if (stepZ < 0.0f)
+            tExit = std::min(tExit, (nodeZ * span - gz) / stepZ);
+
+        const float yIn = ray.originY + ray.dirY * t;
+        const float yOut = ray.originY + ray.dirY * tExit;
+        const float nodeMax = lv.maxHeights[static_cast<std::size_t>(nodeZ) * lv.width + nodeX];
+        const bool above = std::min(yIn, yOut) > nodeMax;
+
+        if (!above && level > 0) {
+            --level;
+            continue;
+        }
+        if (!above && IntersectCell(ray, cellX, cellZ, t - nudge, tExit + nudge, hit))
+            return hit;
+
+        // Nothing in this node: step past it and try the coarser level again
+        if (tExit >= tEnd)
+            break;
+        t = std::max(tExit, t + nudge);
+        level = std::min(level + 1, topLevel);
+    }
+    return hit;
+}
+
+void TerrainRaycaster::CastBatch(const Ray* rays,
+                                 RayHit* hits,
+                                 std::size_t count,
+                                 float maxT) const {
+    jobs::ParallelFor(count, kBatchGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            hits[i] = Cast(rays[i], maxT);
+        }
+    });
+}
@@ -0,0 +1,302 @@
+#include "terrain_scene.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "frame_arena.h"
+#include "jobs.h"
+#include "logger.h"
+
+namespace {
+
+// Indices of a tile of the regular grid, the most any triangulation of it needs
+constexpr std::uint32_t kTileIndices = TerrainScene::kTileCells * TerrainScene::kTileCells * 6;
+// Room added to a tile that outgrows its range, so further edits rarely move the tiles again
+constexpr std::uint32_t kTileSlack = kTileIndices / 8;
+// A separate upload call costs about as much as copying this many more vertices
+constexpr std::uint32_t kVertexSpanGap = 64;
+
+// Sort spans and merge those less than `gap` elements apart
+void MergeSpans(std::vector<BufferSpan>& spans, std::uint32_t gap) {
+    if (spans.size() < 2)
+        return;
+    std::sort(spans.begin(), spans.end(), [](const BufferSpan& a, const BufferSpan& b) {
+        return a.first < b.first;
+    });
+    std::size_t out = 0;
+    for (std::size_t i = 1; i < spans.size(); ++i) {
+        BufferSpan& current = spans[out];
+        const BufferSpan& next = spans[i];
+        if (next.first <= current.first + current.count + gap) {
+            current.count = std::max(current.first + current.count, next.first + next.count) -
+                            current.first;
+        } else {
+            spans[++out] = next;
+        }
+    }
+    spans.resize(out + 1);
+}
+
+}  // namespace
+
+void TerrainScene::Build(int vertsPerSide, float cellSize) {
+    heightfield.Generate(vertsPerSide, cellSize);
+    raycaster.Build(heightfield);
+    tiles = BuildTerrainTiles(heightfield, kTileCells);
+    occluderTiles = BuildTerrainTiles(heightfield, kOccluderTileCells);
+    RebuildOccluders();
+    LOG_INFO("Terrain split into %zu tiles with %zu occluder triangles",
+             tiles.size(),
+             occluderIndices.size() / 3);
+
+    const auto start = std::chrono::steady_clock::now();
+    mesher.Build(heightfield, kTileCells);
+    LOG_INFO("Terrain error map built in %.2f ms",
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                 .count());
+    BuildMesh(true, kDefaultMaxError);
+
+    pendingEdits.Clear();
+    pendingStamps = 0;
+    tileDirty.assign(tiles.size(), 0);
+    dirtyTiles.clear();
+    dirtyTiles.reserve(tiles.size());
+    tileScratch.resize(tiles.size());
+}
+
+void TerrainScene::RebuildOccluders() {
+    occluderPositions.clear();
+    occluderIndices.clear();
+    AppendTileOccluders(occluderTiles, heightfield.MinHeight(), occluderPositions, occluderIndices);
+}
+
+void TerrainScene::BuildMesh(bool adaptive, float maxError) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::uint32_t>> tileIndices(tiles.size());
+    jobs::ParallelFor(tiles.size(), 4, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (adaptive)
+                mesher.AppendTile(tiles[i], maxError, tileIndices[i]);
+            else
+                AppendRegularTile(tiles[i], heightfield.Size(), tileIndices[i]);
+        }
+    });
+
+    meshIndices.clear();
+    tileMeshes.resize(tiles.size());
+    for (std::size_t i = 0; i < tiles.size(); ++i) {
+        tileMeshes[i].firstIndex = static_cast<std::uint32_t>(meshIndices.size());
+        tileMeshes[i].indexCount = static_cast<std::uint32_t>(tileIndices[i].size());
+        tileMeshes[i].capacity = tileMeshes[i].indexCount;
+        meshIndices.insert(meshIndices.end(), tileIndices[i].begin(), tileIndices[i].end());
+    }
+    meshAdaptive = adaptive;
+    meshMaxError = maxError;
+    meshTriangles = meshIndices.size() / 3;
+
+    const std::size_t triangles = meshTriangles;
+    const std::size_t regular = RegularTriangleCount();
+    if (adaptive) {
+        LOG_INFO("Adaptive terrain mesh (max error %.3f): %zu triangles, %.1f%% of the regular "
+                 "grid's %zu (%.1fx fewer), built in %.2f ms",
+                 maxError,
+                 triangles,
+                 regular > 0 ? 100.0 * triangles / regular : 0.0,
+                 regular,
+                 triangles > 0 ? static_cast<double>(regular) / triangles : 0.0,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                     .count());
+    } else {
+        LOG_INFO("Regular terrain mesh: %zu triangles", triangles);
+    }
+}
+
+void TerrainScene::ApplyBrush(const Brush& brush) {
+    pendingEdits.Add(::ApplyBrush(heightfield, brush));
+    ++pendingStamps;
+}
+
+const TerrainUpdate& TerrainScene::FlushEdits() {
+    update.vertexSpans.clear();
+    update.indexSpans.clear();
+    update.indicesRelaid = false;
+    update.stamps = pendingStamps;
+    update.tilesRemeshed = 0;
+    update.cpuMs = 0.0f;
+    pendingStamps = 0;
+    if (pendingEdits.Empty())
+        return update;
+
+    const auto start = std::chrono::steady_clock::now();
+    const int cells = heightfield.Size() - 1;
+    const int tilesPerSide = cells / kTileCells;
+    const int occluderTilesPerSide = cells / kOccluderTileCells;
+    for (std::size_t r = 0; r < pendingEdits.Count(); ++r) {
+        const GridRect& rect = pendingEdits[r];
+        // Every cell with a changed corner
+        raycaster.Refresh({rect.minX - 1, rect.minZ - 1, rect.maxX, rect.maxZ});
+
+        const GridRect drawTiles = TilesOverlapping(rect, kTileCells, tilesPerSide);
+        for (int tz = drawTiles.minZ; tz <= drawTiles.maxZ; ++tz) {
+            for (int tx = drawTiles.minX; tx <= drawTiles.maxX; ++tx) {
+                UpdateTileBounds(heightfield,
+                                 tiles[static_cast<std::size_t>(tz) * tilesPerSide + tx]);
+            }
+        }
+        const GridRect occluders = TilesOverlapping(rect, kOccluderTileCells, occluderTilesPerSide);
+        for (int tz = occluders.minZ; tz <= occluders.maxZ; ++tz) {
+            for (int tx = occluders.minX; tx <= occluders.maxX; ++tx) {
+                UpdateTileBounds(
+                    heightfield,
+                    occluderTiles[static_cast<std::size_t>(tz) * occluderTilesPerSide + tx]);
+            }
+        }
+
+        // The error map is kept current for the regular mesh too, so switching back is exact
+        const GridRect remesh =
+            TilesOverlapping(mesher.Update(heightfield, rect), kTileCells, tilesPerSide);
+        for (int tz = remesh.minZ; meshAdaptive && tz <= remesh.maxZ; ++tz) {
+            for (int tx = remesh.minX; tx <= remesh.maxX; ++tx) {
+                const std::size_t tile = static_cast<std::size_t>(tz) * tilesPerSide + tx;
+                if (!tileDirty[tile]) {
+                    tileDirty[tile] = 1;
+                    dirtyTiles.push_back(static_cast<std::uint32_t>(tile));
+                }
+            }
+        }
+        AddVertexSpans(rect);
+    }
+    pendingEdits.Clear();
+
+    RebuildOccluders();
+    RemeshDirtyTiles();
+    MergeSpans(update.vertexSpans, kVertexSpanGap);
+    MergeSpans(update.indexSpans, 0);
+    update.cpuMs =
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return update;
+}
+
+void TerrainScene::AddVertexSpans(const GridRect& rect) {
+    const auto size = static_cast<std::uint32_t>(heightfield.Size());
+    const auto width = static_cast<std::uint32_t>(rect.maxX - rect.minX + 1);
+    // One span over the whole block when the rest of each row costs less to copy than the
+    // extra calls would
+    if (rect.minZ == rect.maxZ || size - width <= kVertexSpanGap) {
+        const std::uint32_t first = rect.minZ * size + rect.minX;
+        update.vertexSpans.push_back({first, rect.maxZ * size + rect.maxX - first + 1});
+        return;
+    }
+    for (int z = rect.minZ; z <= rect.maxZ; ++z) {
+        update.vertexSpans.push_back({z * size + rect.minX, width});
+    }
+}
+
+void TerrainScene::RemeshDirtyTiles() {
+    if (dirtyTiles.empty())
+        return;
+    jobs::ParallelFor(dirtyTiles.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t tile = dirtyTiles[i];
+            tileScratch[tile].clear();
+            mesher.AppendTile(tiles[tile], meshMaxError, tileScratch[tile]);
+        }
+    });
+
+    // Tiles are rewritten in place while they fit their range
+    bool relayout = false;
+    for (const std::uint32_t tile : dirtyTiles) {
+        const std::vector<std::uint32_t>& indices = tileScratch[tile];
+        const auto count = static_cast<std::uint32_t>(indices.size());
+        TileMesh& mesh = tileMeshes[tile];
+        meshTriangles = meshTriangles - mesh.indexCount / 3 + count / 3;
+        mesh.indexCount = count;
+        if (count > mesh.capacity) {
+            mesh.capacity = std::min(kTileIndices, count + kTileSlack);
+            relayout = true;
+            continue;
+        }
+        const auto first = meshIndices.begin() + mesh.firstIndex;
+        std::copy(indices.begin(), indices.end(), first);
+        std::fill(first + count, first + mesh.capacity, indices.front());
+        update.indexSpans.push_back({mesh.firstIndex, mesh.capacity});
+    }
+
+    // Otherwise every tile moves to make room, and all of them get slack so the next edits
+    // elsewhere fit in place
+    if (relayout) {
+        relayoutScratch.clear();
+        for (std::size_t i = 0; i < tiles.size(); ++i) {
+            TileMesh& mesh = tileMeshes[i];
+            const auto first = static_cast<std::uint32_t>(relayoutScratch.size());
+            const std::uint32_t capacity =
+                std::max(mesh.capacity, std::min(kTileIndices, mesh.indexCount + kTileSlack));
+            if (tileDirty[i]) {
+                relayoutScratch.insert(
+                    relayoutScratch.end(), tileScratch[i].begin(), tileScratch[i].end());
+            } else {
+                const auto source = meshIndices.begin() + mesh.firstIndex;
+                relayoutScratch.insert(relayoutScratch.end(), source, source + mesh.indexCount);
+            }
+            relayoutScratch.resize(first + capacity, relayoutScratch[first]);
+            mesh.firstIndex = first;
+            mesh.capacity = capacity;
+        }
+        meshIndices.swap(relayoutScratch);
+        update.indexSpans.clear();
+        update.indicesRelaid = true;
+    }
+
+    update.tilesRemeshed = static_cast<int>(dirtyTiles.size());
+    for (const std::uint32_t tile : dirtyTiles) {
+        tileDirty[tile] = 0;
+    }
+    dirtyTiles.clear();
+}
+
+const std::uint8_t* TerrainScene::Cull(const Camera& camera,
+                                       const float viewProj[16],
+                                       float zNear,
+                                       const Bounds* objects,
+                                       std::size_t objectCount) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t tileCount = tiles.size();
+    LinearArena& arena = frame::Arena();
+    Bounds* bounds = arena.AllocateArray<Bounds>(tileCount + objectCount);
+    std::uint8_t* visible = arena.AllocateArray<std::uint8_t>(tileCount + objectCount);
+    for (std::size_t i = 0; i < tileCount; ++i) {
+        bounds[i] = tiles[i].bounds;
+    }
+    for (std::size_t i = 0; i < objectCount; ++i) {
+        bounds[tileCount + i] = objects[i];
+    }
+
+    // Frustum culling always; occlusion only when the camera is above the terrain, since the
+    // occluders are only valid from there
+    culler.BeginFrame(viewProj, zNear);
+    const bool occlusionActive = occlusionCulling && heightfield.Contains(camera.x, camera.z) &&
+                                 camera.y > heightfield.SampleHeight(camera.x, camera.z);
+    if (occlusionActive) {
+        culler.RasterizeOccluders(occluderPositions.data(),
+                                  occluderPositions.size() / 3,
+                                  occluderIndices.data(),
+                                  occluderIndices.size() / 3);
+    }
+    culler.TestVisibility(bounds, visible, tileCount + objectCount);
+
+    int tilesVisible = 0;
+    std::size_t indices = 0;
+    for (std::size_t i = 0; i < tileCount; ++i) {
+        tilesVisible += visible[i];
+        if (visible[i])
+            indices += tileMeshes[i].indexCount;
+    }
+    stats = {};
+    stats.tilesTotal = static_cast<int>(tileCount);
+    stats.tilesVisible = tilesVisible;
+    stats.occlusionActive = occlusionActive;
+    stats.triangles = static_cast<int>(indices / 3);
+    stats.cpuMs =
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return visible;
+}
@@ -0,0 +1,116 @@
+#include "terrain_tiles.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "heightfield.h"
+
+std::vector<TerrainTile> BuildTerrainTiles(const Heightfield& field, int tileCells) {
+    std::vector<TerrainTile> tiles;
+    const int cells = field.Size() - 1;
+    if (cells <= 0 || tileCells <= 0)
+        return tiles;
+    const int tilesPerSide = cells / tileCells;
+    tiles.reserve(static_cast<std::size_t>(tilesPerSide) * tilesPerSide);
+    for (int tz = 0; tz < tilesPerSide; ++tz) {
+        for (int tx = 0; tx < tilesPerSide; ++tx) {
+            TerrainTile tile;
+            tile.cellX = tx * tileCells;
+            tile.cellZ = tz * tileCells;
+            tile.cells = tileCells;
+            UpdateTileBounds(field, tile);
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+void UpdateTileBounds(const Heightfield& field, TerrainTile& tile) {
+    float lo = field.At(tile.cellX, tile.cellZ);
+    float hi = lo;
+    for (int z = tile.cellZ; z <= tile.cellZ + tile.cells; ++z) {
+        for (int x = tile.cellX; x <= tile.cellX + tile.cells; ++x) {
+            const float h = field.At(x, z);
+            lo = std::min(lo, h);
+            hi = std::max(hi, h);
+        }
+    }
+    tile.minHeight = lo;
+    tile.maxHeight = hi;
+
+    const float cs = field.CellSize();
+    tile.bounds.minX = field.OriginX() + tile.cellX * cs;
+    tile.bounds.minZ = field.OriginZ() + tile.cellZ * cs;
+    tile.bounds.maxX = tile.bounds.minX + tile.cells * cs;
+    tile.bounds.maxZ = tile.bounds.minZ + tile.cells * cs;
+    tile.bounds.minY = lo;
+    tile.bounds.maxY = hi;
+}
+
+GridRect TilesOverlapping(const GridRect& samples, int tileCells, int tilesPerSide) {
+    if (samples.Empty() || tileCells <= 0)
+        return {};
+    return {std::max(0, (samples.minX - 1) / tileCells),
+            std::max(0, (samples.minZ - 1) / tileCells),
+            std::min(tilesPerSide - 1, samples.maxX / tileCells),
+            std::min(tilesPerSide - 1, samples.maxZ / tileCells)};
+}
+
+namespace {
+
+void AppendQuad(const float corners[4][3],
+                std::vector<float>& positions,
+                std::vector<std::uint32_t>& indices) {
+    const auto base = static_cast<std::uint32_t>(positions.size() / 3);
+    for (int i = 0; i < 4; ++i) {
+        positions.insert(positions.end(), corners[i], corners[i] + 3);
+    }
+    for (std::uint32_t i : {0u, 1u, 2u, 0u, 2u, 3u}) {
+        indices.push_back(base + i);
+    }
+}
+
+}  // namespace
+
+void AppendTileOccluders(const std::vector<TerrainTile>& tiles,
+                         float floorY,
+                         std::vector<float>& positions,
+                         std::vector<std::uint32_t>& indices) {
+    const int tilesPerSide = static_cast<int>(std::lround(std::sqrt(tiles.size())));
+    auto topAt = [&](int tx, int tz) {
+        if (tx < 0 || tz < 0 || tx >= tilesPerSide || tz >= tilesPerSide)
+            return floorY;
+        return std::max(floorY, tiles[static_cast<std::size_t>(tz) * tilesPerSide + tx].minHeight);
+    };
+
+    for (int tz = 0; tz < tilesPerSide; ++tz) {
+        for (int tx = 0; tx < tilesPerSide; ++tx) {
+            const Bounds& b = tiles[static_cast<std::size_t>(tz) * tilesPerSide + tx].bounds;
+            const float top = topAt(tx, tz);
+            const float topFace[4][3] = {{b.minX, top, b.minZ},
+                                         {b.maxX, top, b.minZ},
+                                         {b.maxX, top, b.maxZ},
+                                         {b.minX, top, b.maxZ}};
+            AppendQuad(topFace, positions, indices);
+
+            // Walls down to each lower neighbour: -Z, +X, +Z, -X edges
+            const float edges[4][4] = {{b.minX, b.minZ, b.maxX, b.minZ},
+                                       {b.maxX, b.minZ, b.maxX, b.maxZ},
+                                       {b.maxX, b.maxZ, b.minX, b.maxZ},
+                                       {b.minX, b.maxZ, b.minX, b.minZ}};
+            const float neighbourTops[4] = {
+                topAt(tx, tz - 1), topAt(tx + 1, tz), topAt(tx, tz + 1), topAt(tx - 1, tz)};
+            for (int e = 0; e < 4; ++e) {
+                const float bottom = neighbourTops[e];
+                if (bottom >= top)
+                    continue;
+                const float* edge = edges[e];
+                const float wall[4][3] = {{edge[0], top, edge[1]},
+                                          {edge[2], top, edge[3]},
+                                          {edge[2], bottom, edge[3]},
+                                          {edge[0], bottom, edge[1]}};
+                AppendQuad(wall, positions, indices);
+            }
+        }
+    }
+}
@@ -3,10 +3,15 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <cmath>
 
+#include "alloc_tracker.h"
+#include "frame_arena.h"
+#include "gl_hooks.h"
 #include "logger.h"
 #include "renderer.h"
+#include "startup.h"
 
 #ifdef USE_IMGUI
 #include "backends/imgui_impl_glfw.h"
@@ -17,6 +22,8 @@
 static Renderer renderer;
 static Camera camera = {0.0f, 0.5f, -2.0f, 0.0f, 0.0f, 0.02f};
 static Color currentColor = {1.0f, 0.5f, 0.0f};
+// Most recent frame that applied terrain edits, for the UI
+static TerrainEditStats lastEdit;
 
 static void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     // Update the GL viewport to match the framebuffer size to avoid distortion
@@ -24,10 +31,12 @@ static void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 }
 
 bool Window::Create(int width, int height, const char* title) {
+    double phaseStart = startup::MillisecondsSinceBegin();
     if (!glfwInit()) {
         LOG_ERROR("Failed to initialize GLFW");
         return false;
     }
+    startup::Record("glfwInit", phaseStart);
 
 #if __APPLE__
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -39,6 +48,7 @@ bool Window::Create(int width, int height, const char* title) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 #endif
 
+    phaseStart = startup::MillisecondsSinceBegin();
     window = glfwCreateWindow(width, height, title, nullptr, nullptr);
     if (!window) {
         LOG_ERROR("Failed to create GLFW window");
@@ -47,13 +57,16 @@ bool Window::Create(int width, int height, const char* title) {
     }
 
     glfwMakeContextCurrent(window);
+    startup::Record("window + context", phaseStart);
 
+    phaseStart = startup::MillisecondsSinceBegin();
     if (glewInit() != GLEW_OK) {
         LOG_ERROR("Failed to initialize GLEW");
         return false;
     }
+    startup::Record("glewInit", phaseStart);
 
-    glfwSwapInterval(1);  // vsync
+    pacer.Configure(presentOptions);
 
     int fbw = 0, fbh = 0;
     glfwGetFramebufferSize(window, &fbw, &fbh);
@@ -64,16 +77,23 @@ bool Window::Create(int width, int height, const char* title) {
     glfwSetWindowUserPointer(window, this);
 
     LOG_INFO("Initializing renderer");
+    phaseStart = startup::MillisecondsSinceBegin();
     renderer.Initialize(window);
+    startup::Record("renderer init", phaseStart);
 
 #ifdef USE_IMGUI
+    phaseStart = startup::MillisecondsSinceBegin();
     IMGUI_CHECKVERSION();
+#ifdef TRACK_ALLOCATIONS
+    ImGui::SetAllocatorFunctions(alloc::ImGuiAlloc, alloc::ImGuiFree);
+#endif
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     ImGui::StyleColorsDark();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
+    startup::Record("ImGui init", phaseStart);
 #endif
 
     // Start with mouse captured for FPS-style look; user can toggle with ESC
@@ -92,43 +112,169 @@ void Window::ToggleMouseCapture(bool capture) {
     }
 }
 
+void Window::RecordTo(const std::string& path) {
+    recordPath = path;
+    LOG_INFO("Recording input to %s", path.c_str());
+}
+
+bool Window::ReplayFrom(const std::string& path, const std::string& outputPath) {
+    if (!replay::Load(path, recording))
+        return false;
+    if (recording.frames.empty()) {
+        LOG_ERROR("Recording %s has no frames", path.c_str());
+        return false;
+    }
+    replaying = true;
+    replayFrame = 0;
+    timingsPath = outputPath;
+    return true;
+}
+
+FrameInput Window::PollInput() {
+    FrameInput input;
+    auto key = [&](int k) { return glfwGetKey(window, k) == GLFW_PRESS; };
+    if (key(GLFW_KEY_W))
+        input.keys |= FrameInput::kForward;
+    if (key(GLFW_KEY_S))
+        input.keys |= FrameInput::kBack;
+    if (key(GLFW_KEY_A))
+        input.keys |= FrameInput::kLeft;
+    if (key(GLFW_KEY_D))
+        input.keys |= FrameInput::kRight;
+    if (key(GLFW_KEY_SPACE))
+        input.keys |= FrameInput::kUp;
+    if (key(GLFW_KEY_LEFT_SHIFT))
+        input.keys |= FrameInput::kDown;
+
+    // Mouse look when captured
+    if (mouseCaptured) {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        input.lookX = float(x - lastMouseX);
+        input.lookY = float(y - lastMouseY);
+        lastMouseX = x;
+        lastMouseY = y;
+    }
+    return input;
+}
+
+void Window::FinishReplay(float maxDrift) {
+    gpuTimer.Finish();
+    const std::vector<double>& gpuResults = gpuTimer.Results();
+    for (std::size_t i = 0; i < timings.size() && i < gpuResults.size(); ++i) {
+        timings[i].gpuMs = gpuResults[i];
+    }
+    gpuTimer.Shutdown();
+    renderer.SetAspectRatio(0.0f);
+    LOG_INFO("[replay] replayed %zu of %zu frames, max camera drift %g",
+             timings.size(),
+             recording.frames.size(),
+             maxDrift);
+    replay::LogSummary(timings);
+#ifdef TRACK_GL_CALLS
+    // Per entry point over the whole run, including loading and any frames before the replay
+    glstats::CallReport reports[48];
+    const std::size_t reportCount = glstats::GetReports(reports, 48);
+    for (std::size_t i = 0; i < reportCount; ++i) {
+        LOG_INFO("[replay] %s (%s): %llu calls, %llu bytes, %llu sync",
+                 reports[i].name,
+                 glstats::CategoryName(reports[i].category),
+                 static_cast<unsigned long long>(reports[i].total.calls),
+                 static_cast<unsigned long long>(reports[i].total.bytes),
+                 static_cast<unsigned long long>(reports[i].total.syncCalls));
+    }
+#endif
+    replay::WriteTimings(timingsPath, timings);
+    replaying = false;
+}
+
+void Window::UpdateBrushStroke(bool pressed) {
+    const RayHit& pick = renderer.GetLastPick();
+    if (!pressed || !pick.hit) {
+        brushStroking = false;
+        return;
+    }
+    if (!brushStroking) {
+        // Flatten levels towards the height where the stroke started
+        brushStroking = true;
+        brushLastX = pick.x;
+        brushLastZ = pick.z;
+        brush.height = pick.y;
+    }
+    // Spread this frame's strength over stamps evenly spaced along the cursor's path
+    Brush stamp = brush;
+    stamp.strength = brush.strength / brushStampsPerFrame;
+    for (int i = 1; i <= brushStampsPerFrame; ++i) {
+        const float t = static_cast<float>(i) / brushStampsPerFrame;
+        stamp.x = brushLastX + (pick.x - brushLastX) * t;
+        stamp.z = brushLastZ + (pick.z - brushLastZ) * t;
+        renderer.EditTerrain(stamp);
+    }
+    brushLastX = pick.x;
+    brushLastZ = pick.z;
+}
+
+void Window::RenderLoadingFrame() {
+    // Input is dropped: the camera cannot be placed on terrain that does not exist yet
+    renderer.Render(camera, currentColor);
+#ifdef USE_IMGUI
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(300, 80), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Loading");
+    ImGui::TextUnformatted(renderer.LoadingStatus());
+    ImGui::ProgressBar(renderer.LoadingProgress());
+    ImGui::End();
+    ImGui::Render();
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+#endif
+    pacer.BeforeSwap();
+    glfwSwapBuffers(window);
+    pacer.AfterSwap();
+    startup::MarkFirstFrame();
+    alloc::EndFrame();
+    glstats::EndFrame();
+}
+
 void Window::Run() {
     LOG_INFO("Entering main loop");
+#ifdef TRACK_ALLOCATIONS
+    double allocLogTime = glfwGetTime();
+    alloc::Counters allocSinceLog;
+    int framesSinceLog = 0;
+#endif
+    if (replaying) {
+        camera = recording.start;
+        // Same views as the recording (and the headless replay) whatever the window size
+        renderer.SetAspectRatio(recording.aspect);
+        timings.reserve(recording.frames.size());
+        gpuTimer.Initialize();
+    }
+    if (!recordPath.empty()) {
+        int fbw = 0, fbh = 0;
+        glfwGetFramebufferSize(window, &fbw, &fbh);
+        recording = {};
+        recording.aspect = fbh > 0 ? static_cast<float>(fbw) / fbh : 1.0f;
+        recording.start = camera;
+        recording.frames.reserve(60 * 60);
+    }
+    double recordStart = 0.0;
+    float maxDrift = 0.0f;
+    double pacingLogTime = glfwGetTime();
+
     while (!glfwWindowShouldClose(window)) {
+        // Low-latency limiting waits here, so input below is sampled as late as possible
+        pacer.BeginFrame();
+        const double frameStart = glfwGetTime();
+        // Frame boundary: per-frame transient memory from two frames ago is recycled here
+        frame::BeginFrame();
+        alloc::Scope inputScope("Input");
         glfwPollEvents();
 
-        // Keyboard movement
-        float cosYaw = cosf(camera.yaw), sinYaw = sinf(camera.yaw);
-        float cosPitch = cosf(camera.pitch);
-        float frontX = cosYaw * cosPitch;
-        float frontZ = sinYaw * cosPitch;
-        float rightX = -sinYaw;
-        float rightZ = cosYaw;
-
-        auto key = [&](int k) { return glfwGetKey(window, k) == GLFW_PRESS; };
-        if (key(GLFW_KEY_W)) {
-            camera.x -= rightX * camera.speed;
-            camera.z -= rightZ * camera.speed;
-        }
-        if (key(GLFW_KEY_S)) {
-            camera.x += rightX * camera.speed;
-            camera.z += rightZ * camera.speed;
-        }
-        if (key(GLFW_KEY_A)) {
-            camera.x -= frontX * camera.speed;
-            camera.z -= frontZ * camera.speed;
-        }
-        if (key(GLFW_KEY_D)) {
-            camera.x += frontX * camera.speed;
-            camera.z += frontZ * camera.speed;
-        }
-        if (key(GLFW_KEY_SPACE))
-            camera.y += camera.speed;
-        if (key(GLFW_KEY_LEFT_SHIFT))
-            camera.y -= camera.speed;
-
         static bool escDown = false;
-        if (key(GLFW_KEY_ESCAPE)) {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             if (!escDown) {
                 escDown = true;
                 ToggleMouseCapture(!mouseCaptured);
@@ -137,38 +283,153 @@ void Window::Run() {
             escDown = false;
         }
 
-        // Mouse look when captured
-        if (mouseCaptured) {
-            double x, y;
-            glfwGetCursorPos(window, &x, &y);
-            float deltaX = float(x - lastMouseX) * 0.002f;
-            float deltaY = float(y - lastMouseY) * 0.002f;
-            camera.yaw += deltaX;
-            camera.pitch += deltaY;
-            if (camera.pitch > 1.5f)
-                camera.pitch = 1.5f;
-            if (camera.pitch < -1.5f)
-                camera.pitch = -1.5f;
-            lastMouseX = x;
-            lastMouseY = y;
+        const FrameInput input = PollInput();
+        if (!renderer.Ready()) {
+            RenderLoadingFrame();
+            continue;
+        }
+        const Heightfield& ground = renderer.GetHeightfield();
+        if (replaying) {
+            // Live input is ignored; re-simulating the recorded input checks determinism, and
+            // the recorded camera is then used as is so every build renders the same views
+            const RecordedFrame& recorded = recording.frames[replayFrame];
+            ApplyInput(recorded.input, ground, camera);
+            maxDrift = std::max(maxDrift, replay::Drift(camera, recorded.camera));
+            camera = recorded.camera;
+        } else {
+            ApplyInput(input, ground, camera);
+            if (!recordPath.empty()) {
+                // Timestamps start at the first recorded frame, after loading has finished
+                if (recording.frames.empty())
+                    recordStart = glfwGetTime();
+                recording.frames.push_back({glfwGetTime() - recordStart, input, camera});
+            }
         }
 
 #ifdef USE_IMGUI
+        alloc::Scope uiScope("UI");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
         ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
-        ImGui::SetNextWindowSize(ImVec2(300, 150), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(300, 330), ImGuiCond_FirstUseEver);
         ImGui::Begin("Controls");
         ImGui::Text("Camera: (%.2f, %.2f, %.2f)", camera.x, camera.y, camera.z);
+        const RayHit& pick = renderer.GetLastPick();
+        if (pick.hit)
+            ImGui::Text("Pick: (%.2f, %.2f, %.2f)", pick.x, pick.y, pick.z);
+        else
+            ImGui::Text("Pick: none");
         ImGui::ColorEdit3("Cube Color", &currentColor.r);
         ImGui::Text("Press ESC to toggle mouse capture.");
+        if (replaying)
+            ImGui::Text("Replay: frame %zu/%zu", replayFrame + 1, recording.frames.size());
+        else if (!recordPath.empty())
+            ImGui::Text("Recording: %zu frames", recording.frames.size());
+        const frame::Stats arenaStats = frame::GetStats();
+        ImGui::Text("Frame arena: %zu KB used, %zu KB peak, %zu KB reserved",
+                    arenaStats.mainUsed / 1024,
+                    arenaStats.mainHighWater / 1024,
+                    arenaStats.mainCapacity / 1024);
+        ImGui::Text("Worker arenas: %zu KB peak, %zu KB reserved",
+                    arenaStats.workerHighWater / 1024,
+                    arenaStats.workerCapacity / 1024);
+        ImGui::Separator();
+        bool occlusion = renderer.OcclusionCullingEnabled();
+        if (ImGui::Checkbox("Occlusion culling", &occlusion))
+            renderer.SetOcclusionCulling(occlusion);
+        const CullingStats& culling = renderer.GetCullingStats();
+        const int tilesCulled = culling.tilesTotal - culling.tilesVisible;
+        ImGui::Text("Tiles: %d/%d visible, %.1f%% culled%s",
+                    culling.tilesVisible,
+                    culling.tilesTotal,
+                    culling.tilesTotal > 0 ? 100.0f * tilesCulled / culling.tilesTotal : 0.0f,
+                    culling.occlusionActive ? "" : " (frustum only)");
+        ImGui::Text("Culling: %.3f ms CPU, %d draw ranges, cube %s",
+                    culling.cpuMs,
+                    culling.drawCalls,
+                    culling.cubeVisible ? "visible" : "culled");
+        const TerrainScene& terrain = renderer.GetScene();
+        bool adaptiveMesh = terrain.MeshAdaptive();
+        float maxError = terrain.MeshMaxError();
+        bool meshChanged = ImGui::Checkbox("Adaptive mesh", &adaptiveMesh);
+        if (adaptiveMesh)
+            meshChanged |=
+                ImGui::SliderFloat("Max error", &maxError, 0.0f, kMaxTerrainMeshError, "%.3f");
+        if (meshChanged)
+            renderer.SetTerrainMesh(adaptiveMesh, maxError);
+        const std::size_t meshTriangles = terrain.MeshTriangleCount();
+        ImGui::Text("Terrain: %zu triangles, %.1f%% of the regular grid",
+                    meshTriangles,
+                    100.0 * meshTriangles / terrain.RegularTriangleCount());
+        if (ImGui::CollapsingHeader("Terrain editing")) {
+            // Stamps are not part of a recording, so a replay would run on unedited terrain
+            const bool editLocked = replaying || !recordPath.empty();
+            ImGui::BeginDisabled(editLocked);
+            ImGui::Checkbox("Edit with left mouse button", &terrainEditing);
+            ImGui::EndDisabled();
+            if (editLocked)
+                ImGui::TextDisabled("Disabled while recording or replaying");
+            int brushMode = static_cast<int>(brush.mode);
+            ImGui::RadioButton("Raise", &brushMode, static_cast<int>(BrushMode::kRaise));
+            ImGui::SameLine();
+            ImGui::RadioButton("Lower", &brushMode, static_cast<int>(BrushMode::kLower));
+            ImGui::SameLine();
+            ImGui::RadioButton("Flatten", &brushMode, static_cast<int>(BrushMode::kFlatten));
+            brush.mode = static_cast<BrushMode>(brushMode);
+            ImGui::SliderFloat("Radius", &brush.radius, 0.2f, 5.0f, "%.1f");
+            ImGui::SliderFloat("Strength", &brush.strength, 0.001f, 0.1f, "%.3f");
+            ImGui::SliderInt("Stamps/frame", &brushStampsPerFrame, 1, 200);
+            ImGui::Text("Last edit: %zu stamps, %d tiles remeshed, %.2f ms",
+                        lastEdit.stamps,
+                        lastEdit.tilesRemeshed,
+                        lastEdit.cpuMs);
+            ImGui::Text("Uploads: %d calls, %.1f KB",
+                        lastEdit.uploadCalls,
+                        lastEdit.uploadBytes / 1024.0);
+        }
+        ImGui::End();
+
+        ImGui::SetNextWindowPos(ImVec2(520, 240), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(270, 230), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Presentation");
+        const PresentOptions& present = pacer.Options();
+        static const char* const kModeNames[] = {"Vsync", "Adaptive vsync", "Uncapped", "Limited"};
+        int mode = static_cast<int>(present.mode);
+        if (ImGui::Combo("Mode", &mode, kModeNames, 4))
+            pacer.SetMode(static_cast<PresentMode>(mode));
+        if (present.mode == PresentMode::kLimited) {
+            float targetFps = present.targetFps;
+            if (ImGui::SliderFloat("Target FPS", &targetFps, 10.0f, 360.0f, "%.0f"))
+                pacer.SetTargetFps(targetFps);
+            bool lowLatency = present.lowLatency;
+            if (ImGui::Checkbox("Wait before input (low latency)", &lowLatency))
+                pacer.SetLowLatency(lowLatency);
+        }
+        const PacingStats pacing = pacer.Stats();
+        ImGui::Text("Frame: %.2f ms avg, %.2f ms worst", pacing.averageMs, pacing.worstMs);
+        if (pacing.targetMs > 0.0) {
+            ImGui::Text("Target %.2f ms, jitter %.3f ms", pacing.targetMs, pacing.jitterMs);
+            ImGui::Text("Missed deadlines: %d recent, %llu total",
+                        pacing.missed,
+                        static_cast<unsigned long long>(pacing.missedTotal));
+        } else {
+            ImGui::Text("Jitter %.3f ms", pacing.jitterMs);
+        }
+        ImGui::PlotLines("##frametimes",
+                         pacer.History(),
+                         FramePacer::kHistory,
+                         pacer.HistoryOffset(),
+                         "frame ms",
+                         0.0f,
+                         pacing.targetMs > 0.0 ? static_cast<float>(pacing.targetMs * 3.0) : 50.0f,
+                         ImVec2(0, 80));
         ImGui::End();
 
         static bool show_logs = true;
         if (show_logs) {
-            ImGui::SetNextWindowPos(ImVec2(10, 170), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowPos(ImVec2(10, 350), ImGuiCond_FirstUseEver);
             ImGui::SetNextWindowSize(ImVec2(500, 300), ImGuiCond_FirstUseEver);
             ImGui::Begin("Logs", &show_logs);
 
@@ -178,7 +439,7 @@ void Window::Run() {
             ImGui::BeginChild(
                 "LogScrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
 
-            auto logs = logging::GetRecentLogs(200);
+            auto logs = logging::GetRecentLogs(200, frame::Resource());
             for (const auto& log : logs) {
                 ImGui::TextUnformatted(log.c_str());
             }
@@ -190,18 +451,173 @@ void Window::Run() {
             ImGui::EndChild();
             ImGui::End();
         }
+
+#ifdef TRACK_ALLOCATIONS
+        ImGui::SetNextWindowPos(ImVec2(320, 10), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(360, 220), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Allocations");
+        const alloc::Counters lastFrame = alloc::LastFrame();
+        ImGui::Text("Last frame: %llu allocs, %llu bytes",
+                    static_cast<unsigned long long>(lastFrame.allocations),
+                    static_cast<unsigned long long>(lastFrame.bytes));
+        alloc::TagReport reports[32];
+        const std::size_t reportCount = alloc::GetReports(reports, 32);
+        if (ImGui::BeginTable("AllocTags", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Allocs/frame");
+            ImGui::TableSetupColumn("Bytes/frame");
+            ImGui::TableSetupColumn("Total allocs");
+            ImGui::TableHeadersRow();
+            for (std::size_t i = 0; i < reportCount; ++i) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(reports[i].name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(reports[i].lastFrame.allocations));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(reports[i].lastFrame.bytes));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(reports[i].total.allocations));
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
 #endif
 
+#ifdef TRACK_GL_CALLS
+        ImGui::SetNextWindowPos(ImVec2(520, 480), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(460, 300), ImGuiCond_FirstUseEver);
+        ImGui::Begin("GL calls");
+        const glstats::Counters glFrame = glstats::LastFrame();
+        ImGui::Text("Last frame: %llu calls, %llu draws, %llu state changes",
+                    static_cast<unsigned long long>(glFrame.calls),
+                    static_cast<unsigned long long>(glFrame.draws),
+                    static_cast<unsigned long long>(glFrame.stateChanges));
+        ImGui::Text("Uploads: %llu calls, %.1f KB",
+                    static_cast<unsigned long long>(glFrame.uploads),
+                    glFrame.uploadBytes / 1024.0);
+        ImGui::Text("Queries: %llu, sync points: %llu",
+                    static_cast<unsigned long long>(glFrame.queries),
+                    static_cast<unsigned long long>(glFrame.syncCalls));
+        glstats::CallReport glReports[48];
+        const std::size_t glReportCount = glstats::GetReports(glReports, 48);
+        if (ImGui::BeginTable("GlCalls", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Call");
+            ImGui::TableSetupColumn("Type");
+            ImGui::TableSetupColumn("Calls/frame");
+            ImGui::TableSetupColumn("Bytes/frame");
+            ImGui::TableSetupColumn("Total calls");
+            ImGui::TableHeadersRow();
+            for (std::size_t i = 0; i < glReportCount; ++i) {
+                const glstats::CallReport& report = glReports[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                // Calls that stalled on the driver or GPU this frame are highlighted
+                if (report.lastFrame.syncCalls > 0)
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%s (sync)", report.name);
+                else
+                    ImGui::TextUnformatted(report.name);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(glstats::CategoryName(report.category));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(report.lastFrame.calls));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(report.lastFrame.bytes));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(report.total.calls));
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+#endif
+
+        // Edits are not recorded, so they stay off while recording or replaying
+        const bool brushPressed =
+            terrainEditing && !replaying && recordPath.empty() &&
+            !ImGui::GetIO().WantCaptureMouse &&
+            glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        UpdateBrushStroke(brushPressed);
+#endif
+
+        if (replaying)
+            gpuTimer.Begin(replayFrame);
         renderer.Render(camera, currentColor);
+        if (renderer.GetEditStats().stamps > 0)
+            lastEdit = renderer.GetEditStats();
 
 #ifdef USE_IMGUI
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 #endif
 
+        if (replaying) {
+            gpuTimer.End();
+            const CullingStats& culling = renderer.GetCullingStats();
+            FrameTiming& timing = timings.emplace_back();
+            timing.cpuMs = (glfwGetTime() - frameStart) * 1000.0;
+            timing.cullMs = culling.cpuMs;
+            timing.triangles = culling.triangles;
+            timing.drawCalls = culling.drawCalls;
+#ifdef TRACK_GL_CALLS
+            const glstats::Counters glFrame = glstats::CurrentFrame();
+            timing.glCalls = glFrame.calls;
+            timing.glSyncCalls = glFrame.syncCalls;
+            timing.uploadBytes = glFrame.uploadBytes;
+#endif
+        }
+
+        pacer.BeforeSwap();
         glfwSwapBuffers(window);
+        pacer.AfterSwap();
+
+        if (glfwGetTime() - pacingLogTime >= 5.0) {
+            const PacingStats pacing = pacer.Stats();
+            LOG_INFO("Frame pacing (%s): %.2f ms avg, %.3f ms jitter, %.2f ms worst, %d/%d missed",
+                     PresentModeName(pacer.Options().mode),
+                     pacing.averageMs,
+                     pacing.jitterMs,
+                     pacing.worstMs,
+                     pacing.missed,
+                     pacing.samples);
+            pacingLogTime = glfwGetTime();
+        }
+
+        if (replaying) {
+            gpuTimer.Poll();
+            if (++replayFrame == recording.frames.size()) {
+                FinishReplay(maxDrift);
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+        }
+
+        alloc::EndFrame();
+        glstats::EndFrame();
+#ifdef TRACK_ALLOCATIONS
+        const alloc::Counters frameAllocs = alloc::LastFrame();
+        allocSinceLog.allocations += frameAllocs.allocations;
+        allocSinceLog.bytes += frameAllocs.bytes;
+        ++framesSinceLog;
+        if (glfwGetTime() - allocLogTime >= 5.0) {
+            LOG_INFO("Allocations: %.1f/frame, %.0f bytes/frame over %d frames",
+                     static_cast<double>(allocSinceLog.allocations) / framesSinceLog,
+                     static_cast<double>(allocSinceLog.bytes) / framesSinceLog,
+                     framesSinceLog);
+            allocSinceLog = {};
+            framesSinceLog = 0;
+            allocLogTime = glfwGetTime();
+        }
+#endif
     }
     LOG_INFO("Exiting main loop");
+    if (replaying)
+        FinishReplay(maxDrift);
+    if (!recordPath.empty())
+        replay::Save(recordPath, recording);
+    const frame::Stats arenaStats = frame::GetStats();
+    LOG_INFO("Frame arena high-water: main %zu bytes (%zu reserved), workers %zu bytes",
+             arenaStats.mainHighWater,
+             arenaStats.mainCapacity,
+             arenaStats.workerHighWater);
     renderer.Cleanup();
 #ifdef USE_IMGUI
     ImGui_ImplOpenGL3_Shutdown();